@@ -26,9 +26,12 @@
 #include "DatabaseEnv.h"
 
 #include "AuctionHouseBot.h"
+#include "AuctionHouseBotBulkWriter.h"
 #include "AuctionHouseBotCommon.h"
-
-#include <numeric>
+#include "AuctionHouseBotGovernor.h"
+#include "AuctionHouseBotPlanner.h"
+#include "AuctionHouseBotSampler.h"
+#include "AuctionHouseBotScheduler.h"
 
 using namespace std;
 
@@ -37,10 +40,6 @@ AuctionHouseBot::AuctionHouseBot(uint32 account, uint32 id)
     _account = account;
     _id = id;
 
-    _lastrun_a_sec = time(NULL);
-    _lastrun_h_sec = time(NULL);
-    _lastrun_n_sec = time(NULL);
-
     _allianceConfig = NULL;
     _hordeConfig = NULL;
     _neutralConfig = NULL;
@@ -48,95 +47,27 @@ AuctionHouseBot::AuctionHouseBot(uint32 account, uint32 id)
 
 AuctionHouseBot::~AuctionHouseBot()
 {
-    // Nothing
-}
-
-uint32 AuctionHouseBot::getRandomItemId(std::set<uint32> itemSet, std::map<uint32, uint32> &templateIDToAuctionCount, AHBConfig *config)
-{
-    if (itemSet.empty())
-        throw std::runtime_error("Item set is empty.");
-
-    uint32 itemId;
-    int attempts = 0;
-    const int maxAttempts = 10;
-
-    do {
-        // Generate a random index
-        int randomIndex = urand(0, itemSet.size() - 1);
-        auto it = itemSet.begin();
-        std::advance(it, randomIndex);
-        itemId = *it;
-
-        // Only check auction count if DuplicatesCount is not zero
-        if (config->DuplicatesCount == 0)
-            break;
-
-        // Check the auction count for the selected item
-        uint32 auctionCount = templateIDToAuctionCount.contains(itemId) ? templateIDToAuctionCount.at(itemId) : 0;
-
-        // If the auction count is within the allowed duplicates, break the loop
-        if (auctionCount <= config->DuplicatesCount)
-            break;
-
-        // Prevent infinite looping by limiting attempts
-        attempts++;
-    } while (attempts < maxAttempts);
-
-    return itemId;
-}
+    //
+    // The player refers to the session: release it first
+    //
 
-void AuctionHouseBot::registerAuctionItemID(uint32 itemID, std::map<uint32, uint32> &templateIDToAuctionCount) {
-    if (!templateIDToAuctionCount.contains(itemID)) {
-        templateIDToAuctionCount.emplace(itemID, 1);
-    } else {
-        templateIDToAuctionCount[itemID]++;
-    }
+    _player.reset();
+    _session.reset();
 }
 
-uint32 AuctionHouseBot::getStackCount(AHBConfig *config, uint32 max)
+Player* AuctionHouseBot::getPlayer()
 {
-    if (max == 1)
-    {
-        return 1;
-    }
-
-    //
-    // Organize the stacks in a pseudo random way
-    //
-
-    if (config->DivisibleStacks)
+    if (!_player)
     {
-        uint32 ret = 0;
+        std::string accountName = "AuctionHouseBot" + std::to_string(_account);
 
-        if (max % 5 == 0) // 5, 10, 15, 20
-        {
-            ret = urand(1, 4) * 5;
-        }
+        _session = std::make_unique<WorldSession>(_account, std::move(accountName), nullptr, SEC_PLAYER, sWorld->getIntConfig(CONFIG_EXPANSION), 0, LOCALE_enUS, 0, false, false, 0);
+        _player  = std::make_unique<Player>(_session.get());
 
-        if (max % 4 == 0) // 4, 8, 12, 16
-        {
-            ret = urand(1, 4) * 4;
-        }
-
-        if (max % 3 == 0) // 3, 6, 9, 18
-        {
-            ret = urand(1, 3) * 3;
-        }
-
-        if (ret > max)
-        {
-            ret = max;
-        }
-
-        return ret;
+        _player->Initialize(_id);
     }
 
-    //
-    // More likely to be a whole stack.
-    //
-    bool wholeStack = frand(0, 1) > 0.35; // TODO: Get this from config
-    uint32 cappedMax = config->StackSizeCap == 0 ? max : min(max, config->StackSizeCap);
-    return wholeStack ? cappedMax : urand(1, cappedMax);
+    return _player.get();
 }
 
 uint32 AuctionHouseBot::getElapsedTime(uint32 timeClass)
@@ -154,35 +85,61 @@ uint32 AuctionHouseBot::getElapsedTime(uint32 timeClass)
     }
 }
 
-uint32 AuctionHouseBot::getAuctionCount(AHBConfig *config, AuctionHouseObject *auctionHouse, ObjectGuid guid)
+uint32 AuctionHouseBot::getSmoothedElapsedTime(AHBConfig *config, time_t now)
 {
-    //
-    // All the auctions
-    //
+    uint32 shortest = 0;
+    uint32 longest  = 0;
 
-    if (!config->ConsiderOnlyBotAuctions)
+    switch (config->ElapsingTimeClass)
     {
-        return auctionHouse->Getcount();
+    case 2:
+        shortest = 600;   // SHORT = In the range of one hour
+        longest  = 3000;
+        break;
+
+    case 1:
+        shortest = 3600;  // MEDIUM = In the range of one day
+        longest  = 82800;
+        break;
+
+    default:
+        shortest = 86400; // LONG = More than one day but less than three
+        longest  = 259200;
+        break;
     }
 
     //
-    // Just the one handled by the bot
+    // Take the least crowded of two random times in the window, looking at when the other bot auctions expire.
+    // This spreads the expiries evenly, and fills the gaps left by the previous bursts.
     //
 
-    uint32 count = 0;
+    uint32 first  = urand(shortest, longest);
+    uint32 second = urand(shortest, longest);
 
-    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
+    if (config->GetBotExpiries(now + second) < config->GetBotExpiries(now + first))
     {
-        AuctionEntry *Aentry = itr->second;
+        return second;
+    }
 
-        if (guid == Aentry->owner)
-        {
-            count++;
-            break;
-        }
+    return first;
+}
+
+uint32 AuctionHouseBot::getAuctionCount(AHBConfig *config, AuctionHouseObject *auctionHouse)
+{
+    //
+    // All the auctions
+    //
+
+    if (!config->ConsiderOnlyBotAuctions)
+    {
+        return auctionHouse->Getcount();
     }
 
-    return count;
+    //
+    // Just the ones handled by the bots, from the registry kept by the auction house hooks
+    //
+
+    return config->GetBotAuctions();
 }
 
 // =============================================================================
@@ -238,7 +195,9 @@ void AuctionHouseBot::Buy(Player *AHBplayer, AHBConfig *config, WorldSession *se
     // Perform the operation for a maximum amount of bid attempts (defined in config).
     //
 
-    for (uint32 count = 0; count < config->GetBidsPerInterval(); ++count)
+    uint32 bidsCount = gGovernor->Scale(config->GetBidsPerInterval());
+
+    for (uint32 count = 0; count < bidsCount; ++count)
     {
         //
         // Pick an auction from the pool randomly.
@@ -472,104 +431,121 @@ void AuctionHouseBot::Buy(Player *AHBplayer, AHBConfig *config, WorldSession *se
     }
 }
 
-uint32 selectRandomOutcome(const std::vector<uint32>& outcomes, const std::vector<uint32>& weights) {
-    if (outcomes.size() != weights.size() || outcomes.empty()) {
-        throw std::invalid_argument("Outcomes and weights must have the same non-zero size");
-    }
-
-    // Compute cumulative weights
-    std::vector<uint32> cumulativeWeights(weights.size());
-    std::partial_sum(weights.begin(), weights.end(), cumulativeWeights.begin());
-
-    // Generate a random number in the range [0, totalWeight[
-    int randomValue = urand(0, cumulativeWeights.back() - 1);
-
-    // Find the index where the randomValue fits in cumulativeWeights
-    auto it = std::upper_bound(cumulativeWeights.begin(), cumulativeWeights.end(), randomValue);
-    size_t index = std::distance(cumulativeWeights.begin(), it);
-
-    return outcomes[index];
-}
-
-
 // =============================================================================
-// This routine performs the selling operations for the bot
+// These routines tell, from the counters kept up to date by the hooks, whether
+// an update would sell or buy anything
 // =============================================================================
 
-void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config)
+bool AuctionHouseBot::needsSell(AHBConfig *config, time_t now)
 {
-    //
-    // Check if disabled
-    //
-
     if (!config->AHBSeller)
     {
-        return;
+        return false;
     }
 
     //
-    // Check the given limits
+    // A suspended cycle always has something left to list
     //
 
-    uint32 minAuctionCount = config->GetMinItems();
-    uint32 maxAuctionCount = config->GetMaxItems();
+    auto cursor = _sellCursors.find(config->GetAHID());
 
-    if (maxAuctionCount == 0)
+    if (cursor != _sellCursors.end() && cursor->second.active)
     {
-        return;
+        return true;
     }
 
     //
-    // Retrieve the auction house situation
+    // So does the plan of a sharded round, until the last bot of the round takes the rest of it
     //
 
-    AuctionHouseEntry const *ahEntry = sAuctionMgr->GetAuctionHouseEntry(config->GetAHFID());
+    if (config->SellerSharding && config->HasSellRoundShare())
+    {
+        return true;
+    }
 
-    if (!ahEntry)
+    uint32 maxAuctionCount = config->GetMaxItems();
+
+    if (maxAuctionCount == 0)
     {
-        return;
+        return false;
     }
 
     AuctionHouseObject *auctionHouse = sAuctionMgr->GetAuctionsMap(config->GetAHFID());
 
     if (!auctionHouse)
     {
-        return;
+        return false;
     }
 
-    auctionHouse->Update();
+    uint32 currentAuctionCount = getAuctionCount(config, auctionHouse);
 
+    if (currentAuctionCount >= maxAuctionCount)
+    {
+        return false;
+    }
+
+    if (config->SellerReplenishMode == AHB_REPLENISH_PREDICTIVE)
+    {
+        return config->IsReplenishDue(now);
+    }
+
+    return currentAuctionCount < config->GetMinItems();
+}
+
+bool AuctionHouseBot::needsBuy(AHBConfig *config)
+{
     //
-    // Check if we are clear to proceed
+    // The bidding interval is followed by the scheduler
+    //
+
+    return config->AHBBuyer && config->GetBidsPerInterval() > 0;
+}
+
+// =============================================================================
+// This routine decides how many auctions the auction house needs, and in which
+// categories
+// =============================================================================
+
+bool AuctionHouseBot::planSellCycle(AHBConfig *config, AuctionHouseObject *auctionHouse, uint32 &newAuctionsCount, std::vector<uint32> &missingCounts)
+{
+    //
+    // Check the given limits
     //
 
-    bool aboveMin = false;
-    bool aboveMax = false;
-    uint32 currentAuctionCount = getAuctionCount(config, auctionHouse, AHBplayer->GetGUID());
-    uint32 newAuctionsCount = 0;
+    uint32 minAuctionCount = config->GetMinItems();
+    uint32 maxAuctionCount = config->GetMaxItems();
 
-    if (currentAuctionCount >= minAuctionCount)
+    if (maxAuctionCount == 0)
     {
-        aboveMin = true;
+        return false;
+    }
+
+    //
+    // Check if we are clear to proceed
+    //
 
+    uint32 currentAuctionCount = getAuctionCount(config, auctionHouse);
+
+    bool predictive = config->SellerReplenishMode == AHB_REPLENISH_PREDICTIVE;
+
+    if (currentAuctionCount >= minAuctionCount && !predictive)
+    {
         if (config->DebugOutSeller)
         {
             LOG_INFO("module", "AHBot [{}]: Auctions above minimum", _id);
         }
 
-        return;
+        return false;
     }
 
     if (currentAuctionCount >= maxAuctionCount)
     {
-        aboveMax = true;
-
         if (config->DebugOutSeller)
         {
             LOG_INFO("module", "AHBot [{}]: Auctions at or above maximum", _id);
         }
 
-        return;
+        return false;
     }
 
     if ((maxAuctionCount - currentAuctionCount) >= config->ItemsPerCycle)
@@ -581,6 +557,12 @@ void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config)
         newAuctionsCount = (maxAuctionCount - currentAuctionCount);
     }
 
+    //
+    // Do less under load
+    //
+
+    newAuctionsCount = gGovernor->Scale(newAuctionsCount);
+
     //
     // Retrieve the configuration for this run
     //
@@ -596,7 +578,7 @@ void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config)
     }; // index == value
 
     std::map<uint32, ItemCounts> itemCountsMap;
-    std::vector<uint32> missingCounts(itemTypes.size());
+    missingCounts.assign(itemTypes.size(), 0);
 
     for (size_t i = 0; i < itemTypes.size(); i++) {
         uint32 type = itemTypes[i];
@@ -606,9 +588,85 @@ void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config)
         };
 
         itemCountsMap[type] = counts;
-        missingCounts[i] = config->GetBin(type).size() == 0 ? 0 : counts.MaxCount - counts.CurrentCount;
+        missingCounts[i] = (config->GetBin(type).EligibleCount() == 0 || counts.CurrentCount >= counts.MaxCount) ? 0 : counts.MaxCount - counts.CurrentCount;
     }
 
+    //
+    // In predictive mode list only what the market consumed, plus a share of the gap toward the maximum
+    //
+
+    if (predictive)
+    {
+        missingCounts = config->GetReplenishQuotas(GameTime::GetGameTime().count(), missingCounts, newAuctionsCount);
+        uint32 totalQuota = 0;
+
+        for (size_t i = 0; i < itemTypes.size(); i++)
+        {
+            totalQuota += missingCounts[i];
+        }
+
+        newAuctionsCount = minValue(newAuctionsCount, totalQuota);
+
+        if (newAuctionsCount == 0)
+        {
+            if (config->DebugOutSeller)
+            {
+                LOG_INFO("module", "AHBot [{}]: Nothing to replenish", _id);
+            }
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// =============================================================================
+// This routine starts the next selling cycle of the bot
+// =============================================================================
+
+bool AuctionHouseBot::startSellCycle(AHBConfig *config, AuctionHouseObject *auctionHouse, AHBSellCursor &cursor, uint32 botsLeft)
+{
+    uint32              newAuctionsCount = 0;
+    std::vector<uint32> missingCounts;
+
+    //
+    // When sharding, the needs of the house are planned once by the first bot of the round, then every bot
+    // takes its share of what is left of the plan: with k bots left, one k-th of it, rounded up. The plan
+    // is not computed again by the next bots, since their predecessors already filled a part of the needs.
+    //
+
+    bool sharded = config->SellerSharding && gBots.size() > 1;
+
+    if (!sharded || botsLeft >= gBots.size())
+    {
+        if (!planSellCycle(config, auctionHouse, newAuctionsCount, missingCounts))
+        {
+            if (sharded)
+            {
+                config->SetSellRound(0, {});
+            }
+
+            return false;
+        }
+
+        if (sharded)
+        {
+            config->SetSellRound(newAuctionsCount, missingCounts);
+        }
+    }
+
+    if (sharded && !config->TakeSellRoundShare(botsLeft, newAuctionsCount, missingCounts))
+    {
+        return false;
+    }
+
+    //
+    // The categories are selected according to the missing counts, which are kept updated by the sampler
+    //
+
+    cursor.sampler.Reset(missingCounts);
+
     if (config->TraceSeller)
     {
         std::ostringstream oss;
@@ -621,37 +679,125 @@ void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config)
         LOG_INFO("module", "AHBot [{}]: Will now randomly create auction items for the following respective missing counts for categories: {}", _id, oss.str());
     }
 
+    cursor.active    = true;
+    cursor.requested = newAuctionsCount;
+    cursor.remaining = newAuctionsCount;
+    cursor.sold      = 0;
+    cursor.errors    = 0;
+
+    return true;
+}
+
+// =============================================================================
+// This routine performs the selling operations for the bot
+// =============================================================================
+
+void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config, uint32 botsLeft)
+{
+    //
+    // Check if disabled
+    //
+
+    if (!config->AHBSeller)
+    {
+        return;
+    }
+
     //
-    // Duplicates handling if relevant
+    // Retrieve the auction house situation
     //
-    map<uint32, uint32> templateIDToAuctionCount;
-    if (config->DuplicatesCount) {
-        for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
+
+    AuctionHouseEntry const *ahEntry = sAuctionMgr->GetAuctionHouseEntry(config->GetAHFID());
+
+    if (!ahEntry)
+    {
+        return;
+    }
+
+    AuctionHouseObject *auctionHouse = sAuctionMgr->GetAuctionsMap(config->GetAHFID());
+
+    if (!auctionHouse)
+    {
+        return;
+    }
+
+    //
+    // The expired auctions are not purged here: the bots run from the hook preceding the core auction house update,
+    // which is going to do it right after for every house anyway.
+    //
+
+    //
+    // Start a new selling cycle, unless the previous one has been suspended
+    //
+
+    AHBSellCursor& cursor = _sellCursors[config->GetAHID()];
+
+    if (!cursor.active)
+    {
+        if (!startSellCycle(config, auctionHouse, cursor, botsLeft))
         {
-            AuctionEntry *entry = itr->second;
-            registerAuctionItemID(entry->item_template, templateIDToAuctionCount);
+            return;
         }
     }
+    else if (config->DebugOutSeller)
+    {
+        LOG_INFO("module", "AHBot [{}]: Resuming the selling cycle, {} auctions left", _id, cursor.remaining);
+    }
+
+    //
+    // Let the planner know about changes in the listing profiles
+    //
+
+    if (gPlanner->IsRunning())
+    {
+        gPlanner->Publish(config);
+    }
 
     //
     // Loop variables
     //
 
-    uint32 noSold = 0;   // Tracing counter
-    uint32 err = 0;      // Tracing counter
+    uint32 processed = 0;
+    bool   suspended = false;
+
+    //
+    // The new auctions are persisted in batches, to avoid a commit for every single one
+    //
+
+    CharacterDatabaseTransaction trans = nullptr;
+    uint32 batchCount = 0;
 
-    for (uint32 i = 0; i < newAuctionsCount; i++)
+    //
+    // Optionally, the rows themselves are gathered in multi-row statements
+    //
+
+    AHBBulkWriter bulkWriter(config->SellerBulkInsert);
+
+    while (cursor.remaining > 0)
     {
+        //
+        // Once the time budget of the auction house update is over, leave the rest of the cycle to the next updates
+        //
+
+        if (processed > 0 && gScheduler->IsOverTime())
+        {
+            suspended = true;
+            break;
+        }
+
+        processed++;
+        cursor.remaining--;
+
         //
         // Make sure at least one item can be added.
         //
 
-        bool allZeroCounts = std::all_of(missingCounts.begin(), missingCounts.end(), [](int count) { return count == 0; });
-        if (allZeroCounts) {
+        if (cursor.sampler.Empty()) {
             if (config->DebugOutSeller) {
                 LOG_INFO("module", "AHBot [{}]: No item bin could be selected: all missing counts are zero.", _id);
             }
 
+            cursor.remaining = 0;
             break;
         }
 
@@ -659,45 +805,83 @@ void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config)
         // Select an item bin according to weights.
         //
 
-        uint32 selectedType = selectRandomOutcome(itemTypes, missingCounts);
-        LootIdSet selectedBin = config->GetBin(selectedType);
-        uint32 itemID = getRandomItemId(selectedBin, templateIDToAuctionCount, config);
+        uint32 selectedType = cursor.sampler.Select();
 
-        if (itemID == 0)
-        {
-            if (config->DebugOutSeller)
-            {
-                LOG_INFO("module", "AHBot [{}]: No item could be selected from the bins", _id);
-            }
-
-            continue;
-        }
+        //
+        // Pick an item among the ones not exceeding the duplicates limit: use what has been prepared
+        // by the planner when available, or go for it right away.
+        //
 
-        missingCounts[selectedType]--;
+        AHBItemProfile const* profile = NULL;
+        AHBListingSpec        spec;
 
         //
-        // Retrieve information about the selected item
+        // When targeting the levels, list for the level of a random player online, falling back to any level
+        // when nothing fits it
         //
 
-        ItemTemplate const *prototype = sObjectMgr->GetItemTemplate(itemID);
+        uint32 playerLevel = config->LevelTargeting ? config->GetRandomPlayerLevel() : 0;
 
-        if (prototype == NULL)
+        if (playerLevel)
         {
-            err++;
+            uint32 minLevel = playerLevel > config->LevelRangeBelow ? playerLevel - config->LevelRangeBelow : 0;
+            uint32 maxLevel = playerLevel + config->LevelRangeAbove;
+
+            profile = config->GetBin(selectedType).GetRandomProfile(minLevel, maxLevel);
+        }
 
+        if (profile != NULL)
+        {
+            spec.ItemId     = profile->ItemId;
+            spec.BuyoutRate = urand(profile->MinPrice, profile->MaxPrice);
+            spec.BidRate    = urand(profile->MinBidPrice, profile->MaxBidPrice);
+            spec.StackCount = profile->GetRandomStackCount();
+        }
+        else if (gPlanner->IsRunning() && gPlanner->Pop(config, selectedType, spec))
+        {
+            profile = config->GetBin(selectedType).GetProfile(spec.ItemId);
+        }
+        else
+        {
+            profile = config->GetBin(selectedType).GetRandomProfile();
+
+            if (profile != NULL)
+            {
+                spec.ItemId     = profile->ItemId;
+                spec.BuyoutRate = urand(profile->MinPrice, profile->MaxPrice);
+                spec.BidRate    = urand(profile->MinBidPrice, profile->MaxBidPrice);
+                spec.StackCount = profile->GetRandomStackCount();
+            }
+        }
+
+        if (profile == NULL)
+        {
             if (config->DebugOutSeller)
             {
-                LOG_INFO("module", "AHBot [{}]: could not get prototype of item {}", _id, itemID);
+                LOG_INFO("module", "AHBot [{}]: No item could be selected from the bins", _id);
             }
 
+            //
+            // Every item of the category reached the duplicates limit: stop selecting it for this cycle
+            //
+
+            cursor.sampler.SetWeight(selectedType, 0);
             continue;
         }
 
+        cursor.sampler.DecWeight(selectedType);
+
+        //
+        // Everything about the selected item has been computed when building the bins
+        //
+
+        uint32 itemID = profile->ItemId;
+
         Item *item = Item::CreateItem(itemID, 1, AHBplayer);
 
         if (item == NULL)
         {
-            err++;
+            cursor.errors++;
 
             if (config->DebugOutSeller)
             {
@@ -708,31 +892,17 @@ void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config)
         }
 
         //
-        // Start interacting with the item by adding a random property
+        // Start interacting with the item by adding a random property. The item is not put in the update queue
+        // of the bot player: the player lives as long as the bot, and nothing ever empties its queue.
         //
 
-        item->AddToUpdateQueueOf(AHBplayer);
-
-        uint32 randomPropertyId = Item::GenerateItemRandomPropertyId(itemID);
+        int32 randomPropertyId = config->GetRandomPropertyId(profile);
 
         if (randomPropertyId != 0)
         {
             item->SetItemRandomProperties(randomPropertyId);
         }
 
-        if (prototype->Quality > AHB_MAX_QUALITY)
-        {
-            err++;
-
-            if (config->DebugOutSeller)
-            {
-                LOG_INFO("module", "AHBot [{}]: Quality {} TOO HIGH for item {}", _id, prototype->Quality, itemID);
-            }
-
-            item->RemoveFromUpdateQueueOf(AHBplayer);
-            continue;
-        }
-
         //
         // Determine the price
         //
@@ -748,38 +918,20 @@ void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config)
 
         if (buyoutPrice == 0)
         {
-            if (config->UseBuyPriceForSeller)
-            {
-                buyoutPrice = prototype->BuyPrice;
-            }
-            else
-            {
-                buyoutPrice = prototype->SellPrice;
-            }
+            buyoutPrice = profile->BasePrice;
         }
 
-        buyoutPrice = buyoutPrice * urand(config->GetMinPrice(prototype->Quality), config->GetMaxPrice(prototype->Quality));
+        buyoutPrice = buyoutPrice * spec.BuyoutRate;
         buyoutPrice = buyoutPrice / 100;
 
-        bidPrice = buyoutPrice * urand(config->GetMinBidPrice(prototype->Quality), config->GetMaxBidPrice(prototype->Quality));
+        bidPrice = buyoutPrice * spec.BidRate;
         bidPrice = bidPrice / 100;
 
         //
         // Determine the stack size
         //
 
-        if (config->GetMaxStack(prototype->Quality) > 1 && item->GetMaxStackCount() > 1)
-        {
-            stackCount = minValue(getStackCount(config, item->GetMaxStackCount()), config->GetMaxStack(prototype->Quality));
-        }
-        else if (config->GetMaxStack(prototype->Quality) == 0 && item->GetMaxStackCount() > 1)
-        {
-            stackCount = getStackCount(config, item->GetMaxStackCount());
-        }
-        else
-        {
-            stackCount = 1;
-        }
+        stackCount = spec.StackCount;
 
         item->SetCount(stackCount);
 
@@ -787,19 +939,23 @@ void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config)
         // Determine the auction time
         //
 
-        uint32 etime = getElapsedTime(config->ElapsingTimeClass);
+        time_t now   = GameTime::GetGameTime().count();
+        uint32 etime = config->SmoothExpiryTimes ? getSmoothedElapsedTime(config, now) : getElapsedTime(config->ElapsingTimeClass);
 
         //
         // Determine the deposit
         //
 
-        uint32 dep = sAuctionMgr->GetAuctionDeposit(ahEntry, etime, item, stackCount);
+        uint32 dep = config->GetAuctionDeposit(ahEntry, etime, item, stackCount);
 
         //
         // Perform the auction
         //
 
-        auto trans = CharacterDatabase.BeginTransaction();
+        if (!trans)
+        {
+            trans = CharacterDatabase.BeginTransaction();
+        }
 
         AuctionEntry *auctionEntry = new AuctionEntry();
         auctionEntry->Id = sObjectMgr->GenerateAuctionID();
@@ -812,19 +968,46 @@ void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config)
         auctionEntry->buyout = buyoutPrice * stackCount;
         auctionEntry->bid = 0;
         auctionEntry->deposit = dep;
-        auctionEntry->expire_time = (time_t)etime + time(NULL);
+        auctionEntry->expire_time = (time_t)etime + now;
         auctionEntry->auctionHouseEntry = ahEntry;
 
-        item->SaveToDB(trans);
-        item->RemoveFromUpdateQueueOf(AHBplayer);
+        if (config->SellerBulkInsert)
+        {
+            //
+            // The item is written by the bulk writer: mark it as saved, like Item::SaveToDB does
+            //
+
+            item->SetState(ITEM_UNCHANGED);
+        }
+        else
+        {
+            item->SaveToDB(trans);
+        }
+
         sAuctionMgr->AddAItem(item);
         auctionHouse->AddAuction(auctionEntry);
-        auctionEntry->SaveToDB(trans);
-        registerAuctionItemID(auctionEntry->item_template, templateIDToAuctionCount);
 
-        CharacterDatabase.CommitTransaction(trans);
+        if (config->SellerBulkInsert)
+        {
+            bulkWriter.Add(item, auctionEntry, trans);
+        }
+        else
+        {
+            auctionEntry->SaveToDB(trans);
+        }
 
-        noSold++;
+        batchCount++;
+
+        if (config->SellerBatchSize && batchCount >= config->SellerBatchSize)
+        {
+            bulkWriter.Flush(trans);
+            CharacterDatabase.CommitTransaction(trans);
+
+            trans      = nullptr;
+            batchCount = 0;
+        }
+
+        cursor.sold++;
 
         if (config->TraceSeller)
         {
@@ -832,95 +1015,233 @@ void AuctionHouseBot::Sell(Player *AHBplayer, AHBConfig *config)
         }
     }
 
+    //
+    // Persist whatever is left from the last batch
+    //
+
+    if (trans)
+    {
+        bulkWriter.Flush(trans);
+        CharacterDatabase.CommitTransaction(trans);
+    }
+
+    if (suspended)
+    {
+        if (config->DebugOutSeller)
+        {
+            LOG_INFO("module", "AHBot [{}]: Time budget exhausted, suspending the selling cycle with {} auctions left", _id, cursor.remaining);
+        }
+
+        return;
+    }
+
+    cursor.active = false;
+
     if (config->TraceSeller)
     {
-        LOG_INFO("module", "AHBot [{}]: auctionhouse {}, req={}, sold={}, aboveMin={}, aboveMax={}, err={}", _id, config->GetAHID(), newAuctionsCount, noSold, aboveMin, aboveMax, err);
+        LOG_INFO("module", "AHBot [{}]: auctionhouse {}, req={}, sold={}, err={}", _id, config->GetAHID(), cursor.requested, cursor.sold, cursor.errors);
     }
 }
 
 // =============================================================================
-// Perform an update cycle
+// This routine gives a new life to the bot auctions about to expire
 // =============================================================================
 
-void AuctionHouseBot::Update()
+void AuctionHouseBot::Relist(AHBConfig *config)
 {
-    time_t _newrun = time(NULL);
+    if (!config->RelistExpired)
+    {
+        return;
+    }
 
-    //
-    // If no configuration is associated, then stop here
-    //
+    AuctionHouseObject *auctionHouse = sAuctionMgr->GetAuctionsMap(config->GetAHFID());
 
-    if (!_allianceConfig && !_hordeConfig && !_neutralConfig)
+    if (!auctionHouse)
     {
         return;
     }
 
     //
-    // Preprare for operation
+    // The core expires the auctions ending within the next minute: catch them before
     //
 
-    std::string accountName = "AuctionHouseBot" + std::to_string(_account);
+    time_t now = GameTime::GetGameTime().count();
 
-    WorldSession _session(_account, std::move(accountName), nullptr, SEC_PLAYER, sWorld->getIntConfig(CONFIG_EXPANSION), 0, LOCALE_enUS, 0, false, false, 0);
+    std::vector<std::pair<time_t, uint32>> expiring = config->GetExpiringBotAuctions(now + MINUTE);
 
-    Player _AHBplayer(&_session);
-    _AHBplayer.Initialize(_id);
-
-    ObjectAccessor::AddObject(&_AHBplayer);
+    if (expiring.empty())
+    {
+        return;
+    }
 
     //
-    // Perform update for the factions markets
+    // Above the maximum, let the surplus expire
     //
 
-    if (!sWorld->getBoolConfig(CONFIG_ALLOW_TWO_SIDE_INTERACTION_AUCTION))
+    uint32 currentAuctionCount = getAuctionCount(config, auctionHouse);
+    uint32 surplus             = currentAuctionCount > config->GetMaxItems() ? currentAuctionCount - config->GetMaxItems() : 0;
+
+    CharacterDatabaseTransaction trans = nullptr;
+    uint32 relisted = 0;
+
+    for (auto const& expiry: expiring)
     {
+        AuctionEntry *auction = auctionHouse->GetAuction(expiry.second);
+
+        if (!auction)
+        {
+            config->SkipBotAuction(expiry.second, expiry.first);
+            continue;
+        }
+
         //
-        // Alliance
+        // Auctions with a bid go to the bidder, and the items no longer sold are left to expire.
+        // Either way they leave the index, so the next runs do not look at them again.
         //
 
-        if (_allianceConfig)
+        if (auction->bid != 0 || auction->bidder)
         {
-            Sell(&_AHBplayer, _allianceConfig);
+            config->SkipBotAuction(auction->Id, auction->expire_time);
+            continue;
+        }
 
-            if (((_newrun - _lastrun_a_sec) >= (_allianceConfig->GetBiddingInterval() * MINUTE)) && (_allianceConfig->GetBidsPerInterval() > 0))
-            {
-                Buy(&_AHBplayer, _allianceConfig, &_session);
-                _lastrun_a_sec = _newrun;
-            }
+        if (surplus > 0)
+        {
+            surplus--;
+            config->SkipBotAuction(auction->Id, auction->expire_time);
+            continue;
+        }
+
+        AHBItemProfile const* profile = config->GetItemProfile(auction->item_template);
+
+        if (profile == NULL)
+        {
+            config->SkipBotAuction(auction->Id, auction->expire_time);
+            continue;
         }
 
         //
-        // Horde
+        // Determine the new price, the same way as for a new auction
         //
 
-        if (_hordeConfig)
+        if (config->RelistReprice)
         {
-            Sell(&_AHBplayer, _hordeConfig);
+            uint64 buyoutPrice = 0;
 
-            if (((_newrun - _lastrun_h_sec) >= (_hordeConfig->GetBiddingInterval() * MINUTE)) && (_hordeConfig->GetBidsPerInterval() > 0))
+            if (config->SellAtMarketPrice)
             {
-                Buy(&_AHBplayer, _hordeConfig, &_session);
-                _lastrun_h_sec = _newrun;
+                buyoutPrice = config->GetItemPrice(auction->item_template);
             }
+
+            if (buyoutPrice == 0)
+            {
+                buyoutPrice = profile->BasePrice;
+            }
+
+            buyoutPrice = buyoutPrice * urand(profile->MinPrice, profile->MaxPrice) / 100;
+
+            uint64 bidPrice = buyoutPrice * urand(profile->MinBidPrice, profile->MaxBidPrice) / 100;
+
+            auction->buyout   = buyoutPrice * auction->itemCount;
+            auction->startbid = bidPrice * auction->itemCount;
         }
+
+        //
+        // Determine the new auction time, and update the auction in place
+        //
+
+        uint32 etime = config->SmoothExpiryTimes ? getSmoothedElapsedTime(config, now) : getElapsedTime(config->ElapsingTimeClass);
+
+        config->RescheduleBotAuction(auction, now + etime);
+
+        if (!trans)
+        {
+            trans = CharacterDatabase.BeginTransaction();
+        }
+
+        trans->Append("UPDATE auctionhouse SET time = {}, buyoutprice = {}, startbid = {} WHERE id = {}", auction->expire_time, auction->buyout, auction->startbid, auction->Id);
+
+        relisted++;
     }
 
-    //
-    // Neutral
-    //
+    if (trans)
+    {
+        CharacterDatabase.CommitTransaction(trans);
+    }
 
-    if (_neutralConfig)
+    if (config->DebugOutSeller)
     {
-        Sell(&_AHBplayer, _neutralConfig);
+        LOG_INFO("module", "AHBot [{}]: Relisted {} of {} expiring auctions in auctionhouse {}", _id, relisted, uint32(expiring.size()), config->GetAHID());
+    }
+}
 
-        if (((_newrun - _lastrun_n_sec) >= (_neutralConfig->GetBiddingInterval() * MINUTE)) && (_neutralConfig->GetBidsPerInterval() > 0))
+void AuctionHouseBot::Relist()
+{
+    if (!sWorld->getBoolConfig(CONFIG_ALLOW_TWO_SIDE_INTERACTION_AUCTION))
+    {
+        if (_allianceConfig)
+        {
+            Relist(_allianceConfig);
+        }
+
+        if (_hordeConfig)
         {
-            Buy(&_AHBplayer, _neutralConfig, &_session);
-            _lastrun_n_sec = _newrun;
+            Relist(_hordeConfig);
         }
     }
 
-    ObjectAccessor::RemoveObject(&_AHBplayer);
+    if (_neutralConfig)
+    {
+        Relist(_neutralConfig);
+    }
+}
+
+// =============================================================================
+// Perform an update cycle for an auction house, in the given roles
+// =============================================================================
+
+void AuctionHouseBot::Update(AHBConfig *config, uint32 roles, uint32 botsLeft)
+{
+    //
+    // Only operate on the auction houses the bot has been associated with
+    //
+
+    if (!config || (config != _allianceConfig && config != _hordeConfig && config != _neutralConfig))
+    {
+        return;
+    }
+
+    //
+    // Building the bot player is the most expensive part of an idle update: skip it when there is nothing to do
+    //
+
+    bool sell = (roles & AHB_ROLE_SELLER) && needsSell(config, GameTime::GetGameTime().count());
+    bool buy  = (roles & AHB_ROLE_BUYER)  && needsBuy(config);
+
+    if (!sell && !buy)
+    {
+        return;
+    }
+
+    Player* AHBplayer = getPlayer();
+
+    if (sell)
+    {
+        Sell(AHBplayer, config, botsLeft);
+    }
+
+    //
+    // The bidding goes through the core auction mails, which look the players up: only then the bot player is
+    // made visible to the rest of the world. It is not kept registered, since everything walking the online
+    // players (like saving them all) would then act on this hollow player too.
+    //
+
+    if (buy)
+    {
+        ObjectAccessor::AddObject(AHBplayer);
+        Buy(AHBplayer, config, _session.get());
+        ObjectAccessor::RemoveObject(AHBplayer);
+    }
 }
 
 // =============================================================================
@@ -1063,7 +1384,7 @@ void AuctionHouseBot::Commands(AHBotCommand command, uint32 ahMapID, uint32 col,
             if (itr->second->owner.GetCounter() == _id)
             {
                 // Expired NOW.
-                itr->second->expire_time = GameTime::GetGameTime().count();
+                config->ExpireBotAuction(itr->second, GameTime::GetGameTime().count());
 
                 uint32 id = itr->second->Id;
                 uint32 expire_time = itr->second->expire_time;
@@ -20,12 +20,15 @@
 #ifndef AUCTION_HOUSE_BOT_H
 #define AUCTION_HOUSE_BOT_H
 
+#include <memory>
+
 #include "Common.h"
 #include "ObjectGuid.h"
 #include "AuctionHouseMgr.h"
 
 #include "AuctionHouseBotCommon.h"
 #include "AuctionHouseBotConfig.h"
+#include "AuctionHouseBotSampler.h"
 
 struct AuctionEntry;
 class  Player;
@@ -33,6 +36,20 @@ class  WorldSession;
 
 #define AUCTION_HOUSE_BOT_LOOP_BREAKER 32
 
+//
+// State of a selling cycle, kept between the updates when the cycle runs out of time
+//
+
+struct AHBSellCursor
+{
+    bool               active    = false;
+    uint32             requested = 0;
+    uint32             remaining = 0;
+    uint32             sold      = 0;
+    uint32             errors    = 0;
+    AHBWeightedSampler sampler;
+};
+
 class AuctionHouseBot
 {
 private:
@@ -43,16 +60,33 @@ private:
     AHBConfig* _hordeConfig;
     AHBConfig* _neutralConfig;
 
-    time_t     _lastrun_a_sec;
-    time_t     _lastrun_h_sec;
-    time_t     _lastrun_n_sec;
+    std::map<uint32, AHBSellCursor> _sellCursors; // Per auction house id
+
+    //
+    // Session and player the bot acts with, created on the first update with work and kept until the bot is deleted
+    //
+
+    std::unique_ptr<WorldSession> _session;
+    std::unique_ptr<Player>       _player;
+
+    Player* getPlayer();
 
     //
     // Main operations
     //
 
-    void Sell(Player *AHBplayer, AHBConfig *config);
+    void Sell(Player *AHBplayer, AHBConfig *config, uint32 botsLeft);
+    bool planSellCycle (AHBConfig *config, AuctionHouseObject *auctionHouse, uint32 &newAuctionsCount, std::vector<uint32> &missingCounts);
+    bool startSellCycle(AHBConfig *config, AuctionHouseObject *auctionHouse, AHBSellCursor &cursor, uint32 botsLeft);
     void Buy (Player *AHBplayer, AHBConfig *config, WorldSession *session);
+    void Relist(AHBConfig *config);
+
+    //
+    // Cheap checks performed before preparing the bot player
+    //
+
+    bool needsSell(AHBConfig *config, time_t now);
+    bool needsBuy (AHBConfig *config);
 
     //
     // Utilities
@@ -60,18 +94,17 @@ private:
 
     inline uint32 minValue(uint32 a, uint32 b) { return a <= b ? a : b; };
 
-    uint32 getAuctionCount(AHBConfig* config, AuctionHouseObject* auctionHouse, ObjectGuid guid);
-    uint32 getStackCount(AHBConfig* config, uint32 max);
+    uint32 getAuctionCount(AHBConfig* config, AuctionHouseObject* auctionHouse);
     uint32 getElapsedTime(uint32 timeClass);
-    void registerAuctionItemID(uint32 itemID, std::map<uint32, uint32> &itemIDToAuctionCount);
-    uint32 getRandomItemId(std::set<uint32> itemSet, std::map<uint32, uint32> &itemIDToAuctionCount, AHBConfig *config);
+    uint32 getSmoothedElapsedTime(AHBConfig* config, time_t now);
 
 public:
     AuctionHouseBot(uint32 account, uint32 id);
     ~AuctionHouseBot();
 
     void Initialize(AHBConfig* allianceConfig, AHBConfig* hordeConfig, AHBConfig* neutralConfig);
-    void Update();
+    void Update(AHBConfig* config, uint32 roles, uint32 botsLeft);
+    void Relist();
 
     void Commands(AHBotCommand command, uint32 ahMapID, uint32 col, char* args);
 
@@ -8,6 +8,7 @@
 #include "AuctionHouseBot.h"
 #include "AuctionHouseBotCommon.h"
 #include "AuctionHouseBotAuctionHouseScript.h"
+#include "AuctionHouseBotScheduler.h"
 
 AHBot_AuctionHouseScript::AHBot_AuctionHouseScript() : AuctionHouseScript("AHBot_AuctionHouseScript")
 {
@@ -99,16 +100,30 @@ void AHBot_AuctionHouseScript::OnAuctionAdd(AuctionHouseObject* /*ah*/, AuctionE
         }
     }
 
+    //
+    // Keeps track of the live auctions per template, for the duplicates check
+    //
+
+    config->IncTemplateCount(auction->item_template);
+
+    //
+    // Keeps track of the auctions owned by the bots
+    //
+
+    bool isBotAuction = gBotsId.find(auction->owner.GetCounter()) != gBotsId.end();
+
+    if (isBotAuction)
+    {
+        config->IncBotAuctions(auction);
+    }
+
     // 
     // Consider only those auctions handled by the bots
     // 
 
-    if (config->ConsiderOnlyBotAuctions)
+    if (config->ConsiderOnlyBotAuctions && !isBotAuction)
     {
-        if (gBotsId.find(auction->owner.GetCounter()) != gBotsId.end())
-        {
-            return;
-        }
+        return;
     }
 
     //
@@ -162,16 +177,30 @@ void AHBot_AuctionHouseScript::OnAuctionRemove(AuctionHouseObject* /*ah*/, Aucti
         }
     }
 
+    //
+    // Keeps track of the live auctions per template, for the duplicates check
+    //
+
+    config->DecTemplateCount(auction->item_template);
+
+    //
+    // Keeps track of the auctions owned by the bots
+    //
+
+    bool isBotAuction = gBotsId.find(auction->owner.GetCounter()) != gBotsId.end();
+
+    if (isBotAuction)
+    {
+        config->DecBotAuctions(auction);
+    }
+
     // 
     // Consider only those auctions handled by the bots
     // 
 
-    if (config->ConsiderOnlyBotAuctions)
+    if (config->ConsiderOnlyBotAuctions && !isBotAuction)
     {
-        if (gBotsId.find(auction->owner.GetCounter()) != gBotsId.end())
-        {
-            return;
-        }
+        return;
     }
 
     //
@@ -231,6 +260,8 @@ void AHBot_AuctionHouseScript::OnAuctionSuccessful(AuctionHouseObject* /*ah*/, A
     // 
 
     config->UpdateItemStats(auction->item_template, auction->itemCount, auction->buyout);
+
+    trackConsumption(config, auction);
 }
 
 void AHBot_AuctionHouseScript::OnAuctionExpire(AuctionHouseObject* /*ah*/, AuctionEntry* auction)
@@ -260,16 +291,41 @@ void AHBot_AuctionHouseScript::OnAuctionExpire(AuctionHouseObject* /*ah*/, Aucti
     // 
 
     config->UpdateItemStats(auction->item_template, auction->itemCount, auction->bid);
+
+    trackConsumption(config, auction);
 }
 
-void AHBot_AuctionHouseScript::OnBeforeAuctionHouseMgrUpdate()
+void AHBot_AuctionHouseScript::trackConsumption(AHBConfig* config, AuctionEntry* auction)
 {
     //
-    // For every registered bot, perform an update
+    // Consider only those auctions handled by the bots
     //
 
-    for (AuctionHouseBot* bot: gBots)
+    if (config->ConsiderOnlyBotAuctions)
     {
-        bot->Update();
+        if (gBotsId.find(auction->owner.GetCounter()) == gBotsId.end())
+        {
+            return;
+        }
     }
+
+    //
+    // Sold or expired, the auction has been consumed by the market and the seller can replace it
+    //
+
+    ItemTemplate const* prototype = sObjectMgr->GetItemTemplate(auction->item_template);
+
+    if (prototype)
+    {
+        config->IncConsumedCounts(prototype->Class, prototype->Quality);
+    }
+}
+
+void AHBot_AuctionHouseScript::OnBeforeAuctionHouseMgrUpdate()
+{
+    //
+    // Run the maintenance and the bots jobs which are due
+    //
+
+    gScheduler->Update(GameTime::GetGameTime().count());
 }
@@ -8,12 +8,17 @@
 #include "Player.h"
 #include "ScriptMgr.h"
 
+class AHBConfig;
+
 // =============================================================================
 // Interaction with the auction house core mechanisms
 // =============================================================================
 
 class AHBot_AuctionHouseScript : public AuctionHouseScript
 {
+private:
+    void trackConsumption(AHBConfig* config, AuctionEntry* auction);
+
 public:
     AHBot_AuctionHouseScript();
 
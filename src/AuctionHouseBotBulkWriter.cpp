@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include "AuctionHouseMgr.h"
+#include "DatabaseEnv.h"
+#include "Item.h"
+
+#include "AuctionHouseBotBulkWriter.h"
+
+AHBBulkWriter::AHBBulkWriter(uint32 rowsPerStatement)
+{
+    _rowsPerStatement = rowsPerStatement;
+    _rows             = 0;
+}
+
+void AHBBulkWriter::Add(Item* item, AuctionEntry* auction, CharacterDatabaseTransaction trans)
+{
+    //
+    // Same layout used by Item::SaveToDB for the charges and the enchantments
+    //
+
+    std::ostringstream charges;
+
+    for (uint8 i = 0; i < MAX_ITEM_PROTO_SPELLS; ++i)
+    {
+        charges << item->GetSpellCharges(i) << ' ';
+    }
+
+    std::ostringstream enchantments;
+
+    for (uint8 i = 0; i < MAX_ENCHANTMENT_SLOT; ++i)
+    {
+        enchantments << item->GetEnchantmentId(EnchantmentSlot(i)) << ' ';
+        enchantments << item->GetEnchantmentDuration(EnchantmentSlot(i)) << ' ';
+        enchantments << item->GetEnchantmentCharges(EnchantmentSlot(i)) << ' ';
+    }
+
+    std::string text = item->GetText();
+    CharacterDatabase.EscapeString(text);
+
+    //
+    // item_instance: guid, itemEntry, owner_guid, creatorGuid, giftCreatorGuid, count, duration, charges, flags, enchantments, randomPropertyId, durability, playedTime, text
+    //
+
+    _items << (_rows ? "," : "") << "("
+           << item->GetGUID().GetCounter() << ","
+           << item->GetEntry() << ","
+           << item->GetOwnerGUID().GetCounter() << ","
+           << item->GetGuidValue(ITEM_FIELD_CREATOR).GetCounter() << ","
+           << item->GetGuidValue(ITEM_FIELD_GIFTCREATOR).GetCounter() << ","
+           << item->GetCount() << ","
+           << item->GetUInt32Value(ITEM_FIELD_DURATION) << ","
+           << "'" << charges.str() << "',"
+           << item->GetUInt32Value(ITEM_FIELD_FLAGS) << ","
+           << "'" << enchantments.str() << "',"
+           << item->GetItemRandomPropertyId() << ","
+           << item->GetUInt32Value(ITEM_FIELD_DURABILITY) << ","
+           << item->GetUInt32Value(ITEM_FIELD_CREATE_PLAYED_TIME) << ","
+           << "'" << text << "')";
+
+    //
+    // auctionhouse: id, houseid, itemguid, itemowner, buyoutprice, time, buyguid, lastbid, startbid, deposit
+    //
+
+    _auctions << (_rows ? "," : "") << "("
+              << auction->Id << ","
+              << uint32(auction->houseId) << ","
+              << auction->item_guid.GetCounter() << ","
+              << auction->owner.GetCounter() << ","
+              << auction->buyout << ","
+              << uint32(auction->expire_time) << ","
+              << auction->bidder.GetCounter() << ","
+              << auction->bid << ","
+              << auction->startbid << ","
+              << auction->deposit << ")";
+
+    _rows++;
+
+    if (_rows >= _rowsPerStatement)
+    {
+        Flush(trans);
+    }
+}
+
+void AHBBulkWriter::Flush(CharacterDatabaseTransaction trans)
+{
+    if (_rows == 0)
+    {
+        return;
+    }
+
+    trans->Append("REPLACE INTO item_instance (guid, itemEntry, owner_guid, creatorGuid, giftCreatorGuid, count, duration, charges, flags, enchantments, randomPropertyId, durability, playedTime, text) VALUES " + _items.str());
+    trans->Append("INSERT INTO auctionhouse (id, houseid, itemguid, itemowner, buyoutprice, time, buyguid, lastbid, startbid, deposit) VALUES " + _auctions.str());
+
+    _items.str("");
+    _auctions.str("");
+
+    _rows = 0;
+}
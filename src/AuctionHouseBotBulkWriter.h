@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_BULK_WRITER_H
+#define AUCTION_HOUSE_BOT_BULK_WRITER_H
+
+#include <sstream>
+
+#include "Common.h"
+#include "DatabaseEnvFwd.h"
+
+class  Item;
+struct AuctionEntry;
+
+// =============================================================================
+// Persistence of the new auctions with multi-row statements.
+//
+// Instead of the pair of single-row statements issued by Item::SaveToDB and
+// AuctionEntry::SaveToDB, the rows are gathered and written with one REPLACE
+// into item_instance and one INSERT into auctionhouse every few auctions.
+// The rows are the same ones the core would write.
+// =============================================================================
+
+class AHBBulkWriter
+{
+private:
+    uint32             _rowsPerStatement;
+    uint32             _rows;
+
+    std::ostringstream _items;
+    std::ostringstream _auctions;
+
+public:
+    explicit AHBBulkWriter(uint32 rowsPerStatement);
+
+    void   Add(Item* item, AuctionEntry* auction, CharacterDatabaseTransaction trans);
+    void   Flush(CharacterDatabaseTransaction trans);
+};
+
+#endif // AUCTION_HOUSE_BOT_BULK_WRITER_H
@@ -5,6 +5,9 @@
 #include "AuctionHouseBot.h"
 #include "AuctionHouseBotCommon.h"
 #include "AuctionHouseBotConfig.h"
+#include "AuctionHouseBotGovernor.h"
+#include "AuctionHouseBotPlanner.h"
+#include "AuctionHouseBotScheduler.h"
 
 // 
 // Configuration used globally by all the bots instances
@@ -14,6 +17,24 @@ AHBConfig* gAllianceConfig = new AHBConfig(2);
 AHBConfig* gHordeConfig    = new AHBConfig(6);
 AHBConfig* gNeutralConfig  = new AHBConfig(7);
 
+// 
+// Background generation of the listings
+// 
+
+AHBPlanner* gPlanner       = new AHBPlanner();
+
+// 
+// Timers of the periodic jobs
+// 
+
+AHBScheduler* gScheduler   = new AHBScheduler();
+
+// 
+// Throttling of the bots depending on the server load
+// 
+
+AHBGovernor* gGovernor     = new AHBGovernor();
+
 // 
 // Active bots
 // 
@@ -71,6 +71,34 @@ class AuctionHouseBot;
 #define AHB_ORANGE_I         12
 #define AHB_YELLOW_I         13
 
+#define AHB_CATEGORIES       14
+
+//
+// Seller replenishment modes
+//
+
+#define AHB_REPLENISH_THRESHOLD  0 // Refill in bursts once below the minimum
+#define AHB_REPLENISH_PREDICTIVE 1 // Replace the consumed auctions steadily
+
+//
+// Granularity, in seconds, of the expiry times histogram of the bot auctions
+//
+
+#define AHB_EXPIRY_BUCKET      300
+
+//
+// Largest amount of deposits memorized per auction house
+//
+
+#define AHB_DEPOSIT_CACHE_SIZE 65536
+
+//
+// Roles of a bot update
+//
+
+#define AHB_ROLE_SELLER        1
+#define AHB_ROLE_BUYER         2
+
 //
 // Chat GM commands
 //
@@ -17,14 +17,21 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
 #include "AuctionHouseMgr.h"
 #include "Common.h"
 #include "Config.h"
 #include "DatabaseEnv.h"
+#include "DBCStores.h"
 #include "Item.h"
 #include "ItemTemplate.h"
 #include "Log.h"
 #include "ObjectMgr.h"
+#include "Util.h"
 #include "WorldSession.h"
 
 #include "AuctionHouseBotCommon.h"
@@ -98,6 +105,11 @@ AHBConfig::AHBConfig(uint32 ahid, AHBConfig* conf)
 
     minItems                       = conf->minItems;
     maxItems                       = conf->maxItems;
+    populationFactor               = conf->populationFactor;
+    browseCost                     = conf->browseCost;
+    browseCap                      = conf->browseCap;
+    nextBrowseProbe                = conf->nextBrowseProbe;
+    playerLevels                   = conf->playerLevels;
     percentGreyTradeGoods          = conf->percentGreyTradeGoods;
     percentWhiteTradeGoods         = conf->percentWhiteTradeGoods;
     percentGreenTradeGoods         = conf->percentGreenTradeGoods;
@@ -217,6 +229,9 @@ AHBConfig::AHBConfig(uint32 ahid, AHBConfig* conf)
     Bind_Quest_Item                = conf->Bind_Quest_Item;
     DuplicatesCount                = conf->DuplicatesCount;
     ElapsingTimeClass              = conf->ElapsingTimeClass;
+    SmoothExpiryTimes              = conf->SmoothExpiryTimes;
+    RelistExpired                  = conf->RelistExpired;
+    RelistReprice                  = conf->RelistReprice;
     DivisibleStacks                = conf->DivisibleStacks;
     DisablePermEnchant             = conf->DisablePermEnchant;
     DisableConjured                = conf->DisableConjured;
@@ -255,6 +270,24 @@ AHBConfig::AHBConfig(uint32 ahid, AHBConfig* conf)
     DisableTGsBelowReqSkillRank    = conf->DisableTGsBelowReqSkillRank;
     DisableTGsAboveReqSkillRank    = conf->DisableTGsAboveReqSkillRank;
     StackSizeCap                   = conf->StackSizeCap;
+    SellerBatchSize                = conf->SellerBatchSize;
+    SellerBulkInsert               = conf->SellerBulkInsert;
+    PopulationScaling              = conf->PopulationScaling;
+    PopulationFull                 = conf->PopulationFull;
+    PopulationCurve                = conf->PopulationCurve;
+    PopulationMinFactor            = conf->PopulationMinFactor;
+    PopulationHysteresis           = conf->PopulationHysteresis;
+    BrowseCostCap                  = conf->BrowseCostCap;
+    BrowseTargetLatency            = conf->BrowseTargetLatency;
+    BrowseProbeInterval            = conf->BrowseProbeInterval;
+    LevelTargeting                 = conf->LevelTargeting;
+    LevelRangeBelow                = conf->LevelRangeBelow;
+    LevelRangeAbove                = conf->LevelRangeAbove;
+    SellerReplenishMode            = conf->SellerReplenishMode;
+    SellerRateHalfLife             = conf->SellerRateHalfLife;
+    SellerReplenishTime            = conf->SellerReplenishTime;
+    SellerSharding                 = conf->SellerSharding;
+    SellerInterval                 = conf->SellerInterval;
     
     //
     // Copy the sets
@@ -284,94 +317,44 @@ AHBConfig::AHBConfig(uint32 ahid, AHBConfig* conf)
         SellerWhiteList.insert(id);
     }
 
-    GreyTradeGoodsBin.clear();
-    for (uint32 id: conf->GreyTradeGoodsBin)
-    {
-        GreyTradeGoodsBin.insert(id);
-    }
-
-    WhiteTradeGoodsBin.clear();
-    for (uint32 id: conf->WhiteTradeGoodsBin)
-    {
-        WhiteTradeGoodsBin.insert(id);
-    }
-
-    GreenTradeGoodsBin.clear();
-    for (uint32 id: conf->GreenTradeGoodsBin)
-    {
-        GreenTradeGoodsBin.insert(id);
-    }
-
-    BlueTradeGoodsBin.clear();
-    for (uint32 id: conf->BlueTradeGoodsBin)
-    {
-        BlueTradeGoodsBin.insert(id);
-    }
-
-    PurpleTradeGoodsBin.clear();
-    for (uint32 id: conf->PurpleTradeGoodsBin)
-    {
-        PurpleTradeGoodsBin.insert(id);
-    }
-
-    OrangeTradeGoodsBin.clear();
-    for (uint32 id: conf->OrangeTradeGoodsBin)
-    {
-        OrangeTradeGoodsBin.insert(id);
-    }
-
-    YellowTradeGoodsBin.clear();
-    for (uint32 id: conf->YellowTradeGoodsBin)
-    {
-        YellowTradeGoodsBin.insert(id);
-    }
-
+    GreyTradeGoodsBin              = conf->GreyTradeGoodsBin;
+    WhiteTradeGoodsBin             = conf->WhiteTradeGoodsBin;
+    GreenTradeGoodsBin             = conf->GreenTradeGoodsBin;
+    BlueTradeGoodsBin              = conf->BlueTradeGoodsBin;
+    PurpleTradeGoodsBin            = conf->PurpleTradeGoodsBin;
+    OrangeTradeGoodsBin            = conf->OrangeTradeGoodsBin;
+    YellowTradeGoodsBin            = conf->YellowTradeGoodsBin;
 
     //
     // Bins for items
     //
 
-    GreyItemsBin.clear();
-    for (uint32 id: conf->GreyItemsBin)
-    {
-        GreyItemsBin.insert(id);
-    }
-
-    WhiteItemsBin.clear();
-    for (uint32 id: conf->WhiteItemsBin)
-    {
-        WhiteItemsBin.insert(id);
-    }
+    GreyItemsBin                   = conf->GreyItemsBin;
+    WhiteItemsBin                  = conf->WhiteItemsBin;
+    GreenItemsBin                  = conf->GreenItemsBin;
+    BlueItemsBin                   = conf->BlueItemsBin;
+    PurpleItemsBin                 = conf->PurpleItemsBin;
+    OrangeItemsBin                 = conf->OrangeItemsBin;
+    YellowItemsBin                 = conf->YellowItemsBin;
 
-    GreenItemsBin.clear();
-    for (uint32 id: conf->GreenItemsBin)
-    {
-        GreenItemsBin.insert(id);
-    }
+    randomEnchantRows              = conf->randomEnchantRows;
+    randomEnchantments             = conf->randomEnchantments;
+    depositCache                   = conf->depositCache;
 
-    BlueItemsBin.clear();
-    for (uint32 id: conf->BlueItemsBin)
-    {
-        BlueItemsBin.insert(id);
-    }
+    profilesVersion                = conf->profilesVersion;
 
-    PurpleItemsBin.clear();
-    for (uint32 id: conf->PurpleItemsBin)
-    {
-        PurpleItemsBin.insert(id);
-    }
+    botAuctionsTotal               = conf->botAuctionsTotal;
+    botExpiryCount                 = conf->botExpiryCount;
+    botExpiryIndex                 = conf->botExpiryIndex;
 
-    OrangeItemsBin.clear();
-    for (uint32 id: conf->OrangeItemsBin)
-    {
-        OrangeItemsBin.insert(id);
-    }
+    consumedCounts                 = conf->consumedCounts;
+    consumptionRates               = conf->consumptionRates;
+    replenishCredits               = conf->replenishCredits;
+    pendingQuotas                  = conf->pendingQuotas;
+    lastReplenish                  = conf->lastReplenish;
 
-    YellowItemsBin.clear();
-    for (uint32 id: conf->YellowItemsBin)
-    {
-        YellowItemsBin.insert(id);
-    }
+    sellRoundAuctions              = conf->sellRoundAuctions;
+    sellRoundMissing               = conf->sellRoundMissing;
 }
 
 AHBConfig::~AHBConfig()
@@ -389,6 +372,11 @@ void AHBConfig::Reset()
 
     minItems                       = 0;
     maxItems                       = 0;
+    populationFactor               = 100;
+    browseCost                     = 0;
+    browseCap                      = 0;
+    nextBrowseProbe                = 0;
+    playerLevels.clear();
 
     percentGreyTradeGoods          = 0;
     percentWhiteTradeGoods         = 0;
@@ -460,6 +448,24 @@ void AHBConfig::Reset()
     buyerBidsPerInterval           = 0;
 
     StackSizeCap                   = 0;
+    SellerBatchSize                = 0;
+    SellerBulkInsert               = 0;
+    PopulationScaling              = false;
+    PopulationFull                 = 200;
+    PopulationCurve                = 0.5f;
+    PopulationMinFactor            = 20;
+    PopulationHysteresis           = 10;
+    BrowseCostCap                  = false;
+    BrowseTargetLatency            = 20;
+    BrowseProbeInterval            = 300;
+    LevelTargeting                 = false;
+    LevelRangeBelow                = 5;
+    LevelRangeAbove                = 2;
+    SellerReplenishMode            = AHB_REPLENISH_THRESHOLD;
+    SellerRateHalfLife             = 1800;
+    SellerReplenishTime            = 3600;
+    SellerSharding                 = false;
+    SellerInterval                 = 0;
 
     greytgp                        = 0;
     whitetgp                       = 0;
@@ -529,6 +535,9 @@ void AHBConfig::Reset()
     Bind_Quest_Item                = false;
     DuplicatesCount                = 0;
     ElapsingTimeClass              = 1;
+    SmoothExpiryTimes              = false;
+    RelistExpired                  = false;
+    RelistReprice                  = false;
     DivisibleStacks                = false;
 
     DisablePermEnchant             = false;
@@ -580,25 +589,46 @@ void AHBConfig::Reset()
     DisableItemStore.clear();
     SellerWhiteList.clear();
 
-    GreyTradeGoodsBin.clear();
-    WhiteTradeGoodsBin.clear();
-    GreenTradeGoodsBin.clear();
-    BlueTradeGoodsBin.clear();
-    PurpleTradeGoodsBin.clear();
-    OrangeTradeGoodsBin.clear();
-    YellowTradeGoodsBin.clear();
-
-    GreyItemsBin.clear();
-    WhiteItemsBin.clear();
-    GreenItemsBin.clear();
-    BlueItemsBin.clear();
-    PurpleItemsBin.clear();
-    OrangeItemsBin.clear();
-    YellowItemsBin.clear();
+    GreyTradeGoodsBin.Clear();
+    WhiteTradeGoodsBin.Clear();
+    GreenTradeGoodsBin.Clear();
+    BlueTradeGoodsBin.Clear();
+    PurpleTradeGoodsBin.Clear();
+    OrangeTradeGoodsBin.Clear();
+    YellowTradeGoodsBin.Clear();
+
+    GreyItemsBin.Clear();
+    WhiteItemsBin.Clear();
+    GreenItemsBin.Clear();
+    BlueItemsBin.Clear();
+    PurpleItemsBin.Clear();
+    OrangeItemsBin.Clear();
+    YellowItemsBin.Clear();
+
+    randomEnchantRows.clear();
+    randomEnchantments.clear();
+    depositCache.clear();
 
     itemsCount.clear();
     itemsSum.clear();
     itemsPrice.clear();
+
+    templatesCount.clear();
+
+    botAuctionsTotal               = 0;
+    botExpiryCount.clear();
+    botExpiryIndex.clear();
+
+    profilesVersion                = 0;
+
+    consumedCounts.assign  (AHB_CATEGORIES, 0);
+    consumptionRates.assign(AHB_CATEGORIES, 0.0);
+    replenishCredits.assign(AHB_CATEGORIES, 0.0);
+    pendingQuotas.assign   (AHB_CATEGORIES, 0);
+    lastReplenish                  = 0;
+
+    sellRoundAuctions              = 0;
+    sellRoundMissing.assign(AHB_CATEGORIES, 0);
 }
 
 uint32 AHBConfig::GetAHID()
@@ -618,18 +648,25 @@ void AHBConfig::SetMinItems(uint32 value)
 
 uint32 AHBConfig::GetMinItems()
 {
-    if ((minItems == 0) && (maxItems))
-    {
-        return maxItems;
-    }
-    else if ((maxItems) && (minItems > maxItems))
+    uint32 maximum = GetMaxItems();
+
+    //
+    // No configured minimum means the maximum; a minimum scaled down to nothing stays at nothing
+    //
+
+    if ((minItems == 0) && (maximum))
     {
-        return maxItems;
+        return maximum;
     }
-    else
+
+    uint32 minimum = (uint32)(((double)populationFactor / 100.0) * minItems);
+
+    if ((maximum) && (minimum > maximum))
     {
-        return minItems;
+        return maximum;
     }
+
+    return minimum;
 }
 
 void AHBConfig::SetMaxItems(uint32 value)
@@ -641,7 +678,166 @@ void AHBConfig::SetMaxItems(uint32 value)
 
 uint32 AHBConfig::GetMaxItems()
 {
-    return maxItems;
+    uint32 maximum = (uint32)(((double)populationFactor / 100.0) * maxItems);
+
+    if (browseCap && browseCap < maximum)
+    {
+        return browseCap;
+    }
+
+    return maximum;
+}
+
+void AHBConfig::UpdatePopulation(uint32 players)
+{
+    uint32 factor  = 100;
+    uint32 minimum = std::min(100u, PopulationMinFactor);
+
+    if (PopulationScaling && PopulationFull > 0)
+    {
+        //
+        // From the minimum factor with nobody online, up to the whole targets with the full population.
+        // With a curve below 1 the targets grow quickly with the first players, restocking ahead of the peak.
+        //
+
+        double load = std::min(1.0, (double)players / PopulationFull);
+
+        factor = (uint32)(minimum + (100.0 - minimum) * std::pow(load, (double)PopulationCurve));
+    }
+
+    //
+    // Ignore the small oscillations, but always reach the bounds
+    //
+
+    uint32 change = factor > populationFactor ? factor - populationFactor : populationFactor - factor;
+
+    if (change == 0 || (change < PopulationHysteresis && factor != 100 && factor != minimum))
+    {
+        return;
+    }
+
+    if (DebugOutSeller)
+    {
+        LOG_INFO("module", "AHBot: auctionhouse {}, {} players online, targets scaled from {}% to {}%", AHID, players, populationFactor, factor);
+    }
+
+    populationFactor = factor;
+
+    CalculatePercents();
+}
+
+void AHBConfig::UpdateBrowseCost(time_t now)
+{
+    if (!BrowseCostCap || BrowseTargetLatency == 0)
+    {
+        if (browseCap)
+        {
+            browseCap = 0;
+            CalculatePercents();
+        }
+
+        return;
+    }
+
+    if (now < nextBrowseProbe)
+    {
+        return;
+    }
+
+    nextBrowseProbe = now + BrowseProbeInterval;
+
+    AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(AHFID);
+
+    if (!auctionHouse || auctionHouse->Getcount() < 100)
+    {
+        return;
+    }
+
+    //
+    // Replay what a player search costs the core: resolve every auction item and match its name.
+    // The search text matches nothing, so the whole market is walked like in the worst case.
+    //
+
+    static std::wstring const probeSearch = L"\x01";
+
+    uint32 auctions = 0;
+    uint32 matches  = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
+    {
+        Item* item = sAuctionMgr->GetAItem(itr->second->item_guid);
+
+        if (!item)
+        {
+            continue;
+        }
+
+        ItemTemplate const* proto = item->GetTemplate();
+
+        if (proto->RequiredLevel <= DEFAULT_MAX_LEVEL && Utf8FitTo(proto->Name1, probeSearch))
+        {
+            matches++;
+        }
+
+        auctions++;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if (auctions == 0)
+    {
+        return;
+    }
+
+    //
+    // Smooth the cost, a single probe can be disturbed by the rest of the world update
+    //
+
+    double cost = (double)elapsed / auctions;
+
+    browseCost = browseCost > 0 ? 0.7 * browseCost + 0.3 * cost : cost;
+
+    uint32 cap = (uint32)std::min(((double)BrowseTargetLatency * 1000000.0) / browseCost, (double)std::numeric_limits<uint32>::max());
+
+    if (DebugOutSeller)
+    {
+        LOG_INFO("module", "AHBot: auctionhouse {}, browsing {} auctions took {} us ({} matches), {:.0f} ns per auction, cap {}",
+            AHID, auctions, elapsed / 1000, matches, browseCost, cap);
+    }
+
+    //
+    // Only follow the significant changes, the per category targets are computed again every time
+    //
+
+    if (browseCap && cap > browseCap * 0.95 && cap < browseCap * 1.05)
+    {
+        return;
+    }
+
+    browseCap = cap;
+
+    CalculatePercents();
+}
+
+void AHBConfig::SetPlayerLevels(std::vector<uint8> const& levels)
+{
+    playerLevels = levels;
+}
+
+uint32 AHBConfig::GetRandomPlayerLevel()
+{
+    //
+    // Picking a random player follows the level distribution of the population
+    //
+
+    if (playerLevels.empty())
+    {
+        return 0;
+    }
+
+    return playerLevels[urand(0, playerLevels.size() - 1)];
 }
 
 void AHBConfig::SetPercentages(
@@ -818,6 +1014,8 @@ void AHBConfig::SetMinPrice(uint32 color, uint32 value)
     default:
         break;
     }
+
+    refreshProfiles(color);
 }
 
 uint32 AHBConfig::GetMinPrice(uint32 color)
@@ -990,6 +1188,8 @@ void AHBConfig::SetMaxPrice(uint32 color, uint32 value)
     default:
         break;
     }
+
+    refreshProfiles(color);
 }
 
 uint32 AHBConfig::GetMaxPrice(uint32 color)
@@ -1135,6 +1335,8 @@ void AHBConfig::SetMinBidPrice(uint32 color, uint32 value)
     default:
         break;
     }
+
+    refreshProfiles(color);
 }
 
 uint32 AHBConfig::GetMinBidPrice(uint32 color)
@@ -1280,6 +1482,7 @@ void AHBConfig::SetMaxBidPrice(uint32 color, uint32 value)
         break;
     }
 
+    refreshProfiles(color);
 }
 uint32 AHBConfig::GetMaxBidPrice(uint32 color)
 {
@@ -1423,6 +1626,8 @@ void AHBConfig::SetMaxStack(uint32 color, uint32 value)
     default:
         break;
     }
+
+    refreshProfiles(color);
 }
 
 uint32 AHBConfig::GetMaxStack(uint32 color)
@@ -1568,6 +1773,8 @@ void AHBConfig::CalculatePercents()
     // to be sold in the market
     //
 
+    uint32 maxItems = GetMaxItems();
+
     greytgp   = (uint32)(((double)percentGreyTradeGoods / 100.0) * maxItems);
     whitetgp  = (uint32)(((double)percentWhiteTradeGoods / 100.0) * maxItems);
     greentgp  = (uint32)(((double)percentGreenTradeGoods / 100.0) * maxItems);
@@ -2015,94 +2222,563 @@ uint64 AHBConfig::GetItemPrice(uint32 id)
     return 0;
 }
 
-void AHBConfig::Initialize(std::set<uint32> botsIds)
+void AHBConfig::IncTemplateCount(uint32 id)
 {
-    InitializeFromFile();
-    InitializeFromSql(botsIds);
-    InitializeBins();
-}
+    uint32 count = ++templatesCount[id];
 
-void AHBConfig::InitializeFromFile()
-{
     //
-    // Load from, the configuration file
+    // Once the limit is reached, the template can not be picked anymore by the seller
     //
 
-    DebugOut                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG"        , false);
-    DebugOutConfig                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_CONFIG" , false);
-    DebugOutFilters                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_FILTERS", false);
-    DebugOutBuyer                  = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_BUYER"  , false);
-    DebugOutSeller                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_SELLER" , false);
+    if (DuplicatesCount && count == DuplicatesCount)
+    {
+        if (AHBItemBin* bin = getItemBin(id))
+        {
+            bin->SetEligible(id, false);
+        }
+    }
+}
 
-    TraceSeller                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.TRACE_SELLER" , false);
-    TraceBuyer                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.TRACE_BUYER"  , false);
+void AHBConfig::DecTemplateCount(uint32 id)
+{
+    auto it = templatesCount.find(id);
 
-    AHBSeller                      = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.EnableSeller"           , false);
-    AHBBuyer                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.EnableBuyer"            , false);
-    UseBuyPriceForSeller           = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseBuyPriceForSeller"   , false);
-    UseBuyPriceForBuyer            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseBuyPriceForBuyer"    , false);
-    SellAtMarketPrice              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseMarketPriceForSeller", false);
-    MarketResetThreshold           = sConfigMgr->GetOption<uint32>("AuctionHouseBot.MarketResetThreshold"   , 25);
-    DuplicatesCount                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DuplicatesCount"        , 0);
-    DivisibleStacks                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DivisibleStacks"        , false);
-    ElapsingTimeClass              = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DuplicatesCount"        , 1);
-    ConsiderOnlyBotAuctions        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.ConsiderOnlyBotAuctions", false);
-    ItemsPerCycle                  = sConfigMgr->GetOption<uint32>("AuctionHouseBot.ItemsPerCycle"          , 200);
-    StackSizeCap                   = sConfigMgr->GetOption<uint32>("AuctionHouseBot.StackSizeCap"          , 0);
+    if (it == templatesCount.end())
+    {
+        return;
+    }
 
-    //
-    // Flags: item types
-    //
+    uint32 count = it->second - 1;
 
-    Vendor_Items                   = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.VendorItems"      , false);
-    Loot_Items                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.LootItems"        , true);
-    Other_Items                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.OtherItems"       , false);
-    Vendor_TGs                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.VendorTradeGoods" , false);
-    Loot_TGs                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.LootTradeGoods"   , true);
-    Other_TGs                      = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.OtherTradeGoods"  , false);
+    if (count == 0)
+    {
+        templatesCount.erase(it);
+    }
+    else
+    {
+        it->second = count;
+    }
 
     //
-    // Flags: items binding
+    // Back below the limit, the template can be picked again by the seller
     //
 
-    No_Bind                        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.No_Bind"             , true);
-    Bind_When_Picked_Up            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Picked_Up" , false);
-    Bind_When_Equipped             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Equipped"  , true);
-    Bind_When_Use                  = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Use"       , true);
-    Bind_Quest_Item                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_Quest_Item"     , false);
+    if (DuplicatesCount && count + 1 == DuplicatesCount)
+    {
+        if (AHBItemBin* bin = getItemBin(id))
+        {
+            bin->SetEligible(id, true);
+        }
+    }
+}
 
-    //
-    // Flags: misc
-    //
+void AHBConfig::addBotExpiry(uint32 auctionId, time_t expireTime)
+{
+    ++botExpiryCount[uint32(expireTime / AHB_EXPIRY_BUCKET)];
 
-    DisableConjured                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableConjured"               , false);
-    DisableGems                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableGems"                   , false);
-    DisableMoney                   = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMoney"                  , false);
-    DisableMoneyLoot               = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMoneyLoot"              , false);
-    DisableLootable                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableLootable"               , false);
-    DisableKeys                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableKeys"                   , false);
-    DisableDuration                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDuration"               , false);
-    DisableBOP_Or_Quest_NoReqLevel = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableBOP_Or_Quest_NoReqLevel", false);
+    botExpiryIndex.insert(std::make_pair(expireTime, auctionId));
+}
 
-    //
-    // Flags: items per class
-    //
+void AHBConfig::removeBotExpiry(uint32 auctionId, time_t expireTime)
+{
+    if (botExpiryIndex.erase(std::make_pair(expireTime, auctionId)) == 0)
+    {
+        return;
+    }
 
-    DisableWarriorItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableWarriorItems"    , false);
-    DisablePaladinItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisablePaladinItems"    , false);
-    DisableHunterItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableHunterItems"     , false);
-    DisableRogueItems              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableRogueItems"      , false);
-    DisablePriestItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisablePriestItems"     , false);
-    DisableDKItems                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDKItems"         , false);
-    DisableShamanItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableShamanItems"     , false);
-    DisableMageItems               = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMageItems"       , false);
-    DisableWarlockItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableWarlockItems"    , false);
-    DisableUnusedClassItems        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableUnusedClassItems", false);
-    DisableDruidItems              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDruidItems"      , false);
+    auto bucket = botExpiryCount.find(uint32(expireTime / AHB_EXPIRY_BUCKET));
 
-    //
-    // Items level and skills
-    //
+    if (bucket != botExpiryCount.end() && --bucket->second == 0)
+    {
+        botExpiryCount.erase(bucket);
+    }
+}
+
+void AHBConfig::IncBotAuctions(AuctionEntry const* auction)
+{
+    ++botAuctionsTotal;
+
+    addBotExpiry(auction->Id, auction->expire_time);
+}
+
+void AHBConfig::DecBotAuctions(AuctionEntry const* auction)
+{
+    if (botAuctionsTotal == 0)
+    {
+        return;
+    }
+
+    --botAuctionsTotal;
+
+    removeBotExpiry(auction->Id, auction->expire_time);
+}
+
+uint32 AHBConfig::GetBotAuctions()
+{
+    return botAuctionsTotal;
+}
+
+uint32 AHBConfig::GetBotExpiries(time_t expireTime)
+{
+    auto it = botExpiryCount.find(uint32(expireTime / AHB_EXPIRY_BUCKET));
+
+    if (it == botExpiryCount.end())
+    {
+        return 0;
+    }
+
+    return it->second;
+}
+
+std::vector<std::pair<time_t, uint32>> AHBConfig::GetExpiringBotAuctions(time_t expireTime)
+{
+    std::vector<std::pair<time_t, uint32>> expiring;
+
+    for (auto const& expiry: botExpiryIndex)
+    {
+        if (expiry.first > expireTime)
+        {
+            break;
+        }
+
+        expiring.push_back(expiry);
+    }
+
+    return expiring;
+}
+
+time_t AHBConfig::GetNextBotExpiry()
+{
+    if (botExpiryIndex.empty())
+    {
+        return 0;
+    }
+
+    return botExpiryIndex.begin()->first;
+}
+
+void AHBConfig::RescheduleBotAuction(AuctionEntry* auction, time_t expireTime)
+{
+    removeBotExpiry(auction->Id, auction->expire_time);
+
+    auction->expire_time = expireTime;
+
+    addBotExpiry(auction->Id, auction->expire_time);
+}
+
+void AHBConfig::ExpireBotAuction(AuctionEntry* auction, time_t expireTime)
+{
+    //
+    // Out of the index, the auction is left to the core and not relisted
+    //
+
+    removeBotExpiry(auction->Id, auction->expire_time);
+
+    auction->expire_time = expireTime;
+}
+
+void AHBConfig::SkipBotAuction(uint32 auctionId, time_t expireTime)
+{
+    //
+    // Leave an auction the bots will not relist out of the index, so it is not looked at again
+    //
+
+    removeBotExpiry(auctionId, expireTime);
+}
+
+AHBItemProfile const* AHBConfig::GetItemProfile(uint32 id)
+{
+    AHBItemBin* bin = getItemBin(id);
+
+    if (!bin)
+    {
+        return nullptr;
+    }
+
+    return bin->GetProfile(id);
+}
+
+int32 AHBConfig::GetRandomPropertyId(AHBItemProfile const* profile)
+{
+    if (!profile->RandomEnchantments)
+    {
+        return 0;
+    }
+
+    auto it = randomEnchantments.find(profile->RandomEnchantments);
+
+    if (it == randomEnchantments.end())
+    {
+        return 0;
+    }
+
+    return it->second.Ids[it->second.Sampler.Select()];
+}
+
+uint32 AHBConfig::GetAuctionDeposit(AuctionHouseEntry const* ahEntry, uint32 etime, Item* item, uint32 stackCount)
+{
+    //
+    // The core computes the deposit from the sell price of the template, the house rate and the duration
+    // counted in whole periods of 12 hours: within a house, these keys give the same deposit every time
+    //
+
+    uint64 key = (uint64(item->GetEntry()) << 32) | (uint64(std::min<uint32>(etime / (12 * HOUR), 0xFF)) << 24) | std::min<uint32>(stackCount, 0xFFFFFF);
+
+    auto it = depositCache.find(key);
+
+    if (it != depositCache.end())
+    {
+        return it->second;
+    }
+
+    uint32 deposit = sAuctionMgr->GetAuctionDeposit(ahEntry, etime, item, stackCount);
+
+    //
+    // Keep the cache bounded, it fills again quickly with the templates actually listed
+    //
+
+    if (depositCache.size() >= AHB_DEPOSIT_CACHE_SIZE)
+    {
+        depositCache.clear();
+    }
+
+    depositCache[key] = deposit;
+
+    return deposit;
+}
+
+uint32 AHBConfig::GetProfilesVersion()
+{
+    return profilesVersion;
+}
+
+void AHBConfig::IncConsumedCounts(uint32 Class, uint32 Quality)
+{
+    if (Quality > AHB_MAX_QUALITY)
+    {
+        return;
+    }
+
+    if (Class == ITEM_CLASS_TRADE_GOODS)
+    {
+        consumedCounts[Quality]++;
+    }
+    else
+    {
+        consumedCounts[Quality + 7]++;
+    }
+}
+
+std::vector<uint32> AHBConfig::GetReplenishQuotas(time_t now, std::vector<uint32> const& limits, uint32 total)
+{
+    std::vector<uint32> quotas(AHB_CATEGORIES, 0);
+
+    if (lastReplenish == 0)
+    {
+        lastReplenish = now;
+        return quotas;
+    }
+
+    //
+    // The quotas are evaluated at most once per second, then claimed: a claim never exceeds the given
+    // limits, and only what is claimed leaves the pending quotas, so the rest is kept for the next claims
+    //
+
+    if (now > lastReplenish)
+    {
+        evaluateReplenishQuotas(now);
+    }
+
+    uint32 claimed = 0;
+
+    for (uint32 i = 0; i < AHB_CATEGORIES && i < limits.size(); ++i)
+    {
+        quotas[i] = std::min(pendingQuotas[i], limits[i]);
+        claimed  += quotas[i];
+    }
+
+    //
+    // Over the total, the categories are reduced in proportion, and the rounding leftovers are handed
+    // out in order
+    //
+
+    if (claimed > total)
+    {
+        std::vector<uint32> wanted = quotas;
+        uint32 granted = 0;
+
+        for (uint32 i = 0; i < AHB_CATEGORIES; ++i)
+        {
+            quotas[i] = uint32(uint64(wanted[i]) * total / claimed);
+            granted  += quotas[i];
+        }
+
+        for (uint32 i = 0; i < AHB_CATEGORIES && granted < total; ++i)
+        {
+            if (quotas[i] < wanted[i])
+            {
+                quotas[i]++;
+                granted++;
+            }
+        }
+    }
+
+    for (uint32 i = 0; i < AHB_CATEGORIES; ++i)
+    {
+        pendingQuotas[i] -= quotas[i];
+    }
+
+    return quotas;
+}
+
+bool AHBConfig::IsReplenishDue(time_t now)
+{
+    if (lastReplenish == 0 || now > lastReplenish)
+    {
+        return true;
+    }
+
+    for (uint32 quota: pendingQuotas)
+    {
+        if (quota > 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void AHBConfig::SetSellRound(uint32 auctions, std::vector<uint32> const& missing)
+{
+    sellRoundAuctions = auctions;
+    sellRoundMissing.assign(AHB_CATEGORIES, 0);
+
+    for (uint32 i = 0; i < AHB_CATEGORIES && i < missing.size(); ++i)
+    {
+        sellRoundMissing[i] = missing[i];
+    }
+}
+
+bool AHBConfig::TakeSellRoundShare(uint32 shares, uint32& auctions, std::vector<uint32>& missing)
+{
+    //
+    // The share is one part of what is left of the round, rounded up, so the last bot takes all of it
+    //
+
+    shares   = std::max(shares, 1u);
+
+    auctions = (sellRoundAuctions + shares - 1) / shares;
+    sellRoundAuctions -= auctions;
+
+    missing.assign(AHB_CATEGORIES, 0);
+
+    for (uint32 i = 0; i < AHB_CATEGORIES; ++i)
+    {
+        missing[i]           = (sellRoundMissing[i] + shares - 1) / shares;
+        sellRoundMissing[i] -= missing[i];
+    }
+
+    return auctions > 0;
+}
+
+bool AHBConfig::HasSellRoundShare()
+{
+    return sellRoundAuctions > 0;
+}
+
+void AHBConfig::evaluateReplenishQuotas(time_t now)
+{
+    double elapsed = double(now - lastReplenish);
+    lastReplenish  = now;
+
+    //
+    // Smooth the measured consumption with an exponential moving average; the weight of the new
+    // sample depends on the elapsed time, so that irregular evaluations are handled correctly.
+    //
+
+    double alpha = 1.0;
+
+    if (SellerRateHalfLife > 0)
+    {
+        alpha = 1.0 - std::exp2(-elapsed / SellerRateHalfLife);
+    }
+
+    double recovery = 1.0;
+
+    if (SellerReplenishTime > 0)
+    {
+        recovery = std::min(1.0, elapsed / SellerReplenishTime);
+    }
+
+    for (uint32 i = 0; i < AHB_CATEGORIES; ++i)
+    {
+        consumptionRates[i] += alpha * ((consumedCounts[i] / elapsed) - consumptionRates[i]);
+        consumedCounts[i]    = 0;
+
+        uint32 current = GetItemCounts(i);
+        uint32 maximum = GetMaximum(i);
+        uint32 missing = current >= maximum ? 0 : maximum - current;
+
+        //
+        // Replace what is expected to be consumed until the next evaluation, and close a share of the gap
+        //
+
+        replenishCredits[i] += consumptionRates[i] * elapsed + missing * recovery;
+
+        uint32 quota = std::min(uint32(replenishCredits[i]), missing);
+
+        replenishCredits[i] = std::min(replenishCredits[i] - quota, 1.0);
+        pendingQuotas[i]    = std::min(pendingQuotas[i] + quota, missing);
+    }
+}
+
+void AHBConfig::Initialize(std::set<uint32> botsIds)
+{
+    InitializeFromFile();
+    InitializeFromSql(botsIds);
+    InitializeBins();
+    InitializeBotAuctions(botsIds);
+}
+
+void AHBConfig::InitializeBotAuctions(std::set<uint32> botsIds)
+{
+    //
+    // The hooks keep the registry updated, but the bots may have changed with a reload: count again from the market
+    //
+
+    botAuctionsTotal = 0;
+    botExpiryCount.clear();
+    botExpiryIndex.clear();
+
+    AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(AHFID);
+
+    if (!auctionHouse)
+    {
+        return;
+    }
+
+    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
+    {
+        uint32 owner = itr->second->owner.GetCounter();
+
+        if (botsIds.find(owner) != botsIds.end())
+        {
+            IncBotAuctions(itr->second);
+        }
+    }
+}
+
+void AHBConfig::InitializeFromFile()
+{
+    //
+    // Load from, the configuration file
+    //
+
+    DebugOut                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG"        , false);
+    DebugOutConfig                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_CONFIG" , false);
+    DebugOutFilters                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_FILTERS", false);
+    DebugOutBuyer                  = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_BUYER"  , false);
+    DebugOutSeller                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_SELLER" , false);
+
+    TraceSeller                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.TRACE_SELLER" , false);
+    TraceBuyer                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.TRACE_BUYER"  , false);
+
+    AHBSeller                      = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.EnableSeller"           , false);
+    AHBBuyer                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.EnableBuyer"            , false);
+    UseBuyPriceForSeller           = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseBuyPriceForSeller"   , false);
+    UseBuyPriceForBuyer            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseBuyPriceForBuyer"    , false);
+    SellAtMarketPrice              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseMarketPriceForSeller", false);
+    MarketResetThreshold           = sConfigMgr->GetOption<uint32>("AuctionHouseBot.MarketResetThreshold"   , 25);
+    DuplicatesCount                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DuplicatesCount"        , 0);
+    DivisibleStacks                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DivisibleStacks"        , false);
+    ElapsingTimeClass              = sConfigMgr->GetOption<uint32>("AuctionHouseBot.ElapsingTimeClass"      , 1);
+    SmoothExpiryTimes              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.SmoothExpiryTimes"      , false);
+    RelistExpired                  = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.RelistExpired"          , false);
+    RelistReprice                  = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.RelistReprice"          , false);
+    ConsiderOnlyBotAuctions        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.ConsiderOnlyBotAuctions", false);
+    ItemsPerCycle                  = sConfigMgr->GetOption<uint32>("AuctionHouseBot.ItemsPerCycle"          , 200);
+    StackSizeCap                   = sConfigMgr->GetOption<uint32>("AuctionHouseBot.StackSizeCap"          , 0);
+    SellerBatchSize                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerBatchSize"        , 0);
+    SellerBulkInsert               = sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerBulkInsert"       , 0);
+    PopulationScaling              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.PopulationScaling"      , false);
+    PopulationFull                 = sConfigMgr->GetOption<uint32>("AuctionHouseBot.PopulationFull"         , 200);
+    PopulationCurve                = sConfigMgr->GetOption<float> ("AuctionHouseBot.PopulationCurve"        , 0.5f);
+    PopulationMinFactor            = std::min(100u, sConfigMgr->GetOption<uint32>("AuctionHouseBot.PopulationMinFactor", 20));
+    PopulationHysteresis           = sConfigMgr->GetOption<uint32>("AuctionHouseBot.PopulationHysteresis"   , 10);
+    BrowseCostCap                  = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.BrowseCostCap"          , false);
+    BrowseTargetLatency            = sConfigMgr->GetOption<uint32>("AuctionHouseBot.BrowseTargetLatency"    , 20);
+    BrowseProbeInterval            = sConfigMgr->GetOption<uint32>("AuctionHouseBot.BrowseProbeInterval"    , 300);
+    LevelTargeting                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.LevelTargeting"         , false);
+    LevelRangeBelow                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.LevelRangeBelow"        , 5);
+    LevelRangeAbove                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.LevelRangeAbove"        , 2);
+    SellerReplenishMode            = sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerReplenishMode"    , AHB_REPLENISH_THRESHOLD);
+    SellerRateHalfLife             = sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerRateHalfLife"     , 1800);
+    SellerReplenishTime            = sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerReplenishTime"    , 3600);
+    SellerSharding                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.SellerSharding"         , false);
+    SellerInterval                 = sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerInterval"         , 0);
+
+    //
+    // The seller interval can be set for a single auction house
+    //
+
+    std::string houseName = AHID == 2 ? "Alliance" : (AHID == 6 ? "Horde" : "Neutral");
+
+    SellerInterval                 = sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerInterval." + houseName, SellerInterval, false);
+
+    //
+    // Flags: item types
+    //
+
+    Vendor_Items                   = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.VendorItems"      , false);
+    Loot_Items                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.LootItems"        , true);
+    Other_Items                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.OtherItems"       , false);
+    Vendor_TGs                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.VendorTradeGoods" , false);
+    Loot_TGs                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.LootTradeGoods"   , true);
+    Other_TGs                      = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.OtherTradeGoods"  , false);
+
+    //
+    // Flags: items binding
+    //
+
+    No_Bind                        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.No_Bind"             , true);
+    Bind_When_Picked_Up            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Picked_Up" , false);
+    Bind_When_Equipped             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Equipped"  , true);
+    Bind_When_Use                  = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Use"       , true);
+    Bind_Quest_Item                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_Quest_Item"     , false);
+
+    //
+    // Flags: misc
+    //
+
+    DisableConjured                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableConjured"               , false);
+    DisableGems                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableGems"                   , false);
+    DisableMoney                   = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMoney"                  , false);
+    DisableMoneyLoot               = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMoneyLoot"              , false);
+    DisableLootable                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableLootable"               , false);
+    DisableKeys                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableKeys"                   , false);
+    DisableDuration                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDuration"               , false);
+    DisableBOP_Or_Quest_NoReqLevel = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableBOP_Or_Quest_NoReqLevel", false);
+
+    //
+    // Flags: items per class
+    //
+
+    DisableWarriorItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableWarriorItems"    , false);
+    DisablePaladinItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisablePaladinItems"    , false);
+    DisableHunterItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableHunterItems"     , false);
+    DisableRogueItems              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableRogueItems"      , false);
+    DisablePriestItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisablePriestItems"     , false);
+    DisableDKItems                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDKItems"         , false);
+    DisableShamanItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableShamanItems"     , false);
+    DisableMageItems               = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMageItems"       , false);
+    DisableWarlockItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableWarlockItems"    , false);
+    DisableUnusedClassItems        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableUnusedClassItems", false);
+    DisableDruidItems              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDruidItems"      , false);
+
+    //
+    // Items level and skills
+    //
 
     DisableItemsBelowLevel         = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsBelowLevel"       , 0);
     DisableItemsAboveLevel         = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsAboveLevel"       , 0);
@@ -2551,10 +3227,58 @@ void AHBConfig::InitializeFromSql(std::set<uint32> botsIds)
     {
         LOG_INFO("module", "Loaded {} items from lootable items", uint32(LootItems.size()));
     }
+
+    //
+    // Reload the random enchantments chances, the tables are built from them with the bins
+    //
+
+    randomEnchantRows.clear();
+
+    QueryResult enchantResults = WorldDatabase.Query("SELECT entry, ench, chance FROM item_enchantment_template");
+
+    if (enchantResults)
+    {
+        do
+        {
+            Field* fields = enchantResults->Fetch();
+            randomEnchantRows[fields[0].Get<uint32>()].emplace_back(fields[1].Get<uint32>(), fields[2].Get<float>());
+
+        } while (enchantResults->NextRow());
+    }
+
+    if (DebugOutConfig)
+    {
+        LOG_INFO("module", "Loaded {} random enchantments entries", uint32(randomEnchantRows.size()));
+    }
 }
 
 void AHBConfig::InitializeBins()
 {
+    //
+    // Start from empty bins, since this is performed again when reloading the configuration
+    //
+
+    profilesVersion++;
+
+    randomEnchantments.clear();
+    depositCache.clear();
+
+    GreyTradeGoodsBin.Clear();
+    WhiteTradeGoodsBin.Clear();
+    GreenTradeGoodsBin.Clear();
+    BlueTradeGoodsBin.Clear();
+    PurpleTradeGoodsBin.Clear();
+    OrangeTradeGoodsBin.Clear();
+    YellowTradeGoodsBin.Clear();
+
+    GreyItemsBin.Clear();
+    WhiteItemsBin.Clear();
+    GreenItemsBin.Clear();
+    BlueItemsBin.Clear();
+    PurpleItemsBin.Clear();
+    OrangeItemsBin.Clear();
+    YellowItemsBin.Clear();
+
     //
     // Exclude items depending on the configuration; whatever passes all the tests is put in the lists.
     //
@@ -3261,36 +3985,39 @@ void AHBConfig::InitializeBins()
         // Now that the items passed all the tests, organize it by quality
         //
 
+        AHBItemProfile profile;
+        initializeProfile(profile, &itr->second);
+
         if (itr->second.Class == ITEM_CLASS_TRADE_GOODS)
         {
             switch (itr->second.Quality)
             {
             case AHB_GREY:
-                GreyTradeGoodsBin.insert(itr->second.ItemId);
+                GreyTradeGoodsBin.Add(profile);
                 break;
 
             case AHB_WHITE:
-                WhiteTradeGoodsBin.insert(itr->second.ItemId);
+                WhiteTradeGoodsBin.Add(profile);
                 break;
 
             case AHB_GREEN:
-                GreenTradeGoodsBin.insert(itr->second.ItemId);
+                GreenTradeGoodsBin.Add(profile);
                 break;
 
             case AHB_BLUE:
-                BlueTradeGoodsBin.insert(itr->second.ItemId);
+                BlueTradeGoodsBin.Add(profile);
                 break;
 
             case AHB_PURPLE:
-                PurpleTradeGoodsBin.insert(itr->second.ItemId);
+                PurpleTradeGoodsBin.Add(profile);
                 break;
 
             case AHB_ORANGE:
-                OrangeTradeGoodsBin.insert(itr->second.ItemId);
+                OrangeTradeGoodsBin.Add(profile);
                 break;
 
             case AHB_YELLOW:
-                YellowTradeGoodsBin.insert(itr->second.ItemId);
+                YellowTradeGoodsBin.Add(profile);
                 break;
             }
         }
@@ -3299,31 +4026,31 @@ void AHBConfig::InitializeBins()
             switch (itr->second.Quality)
             {
             case AHB_GREY:
-                GreyItemsBin.insert(itr->second.ItemId);
+                GreyItemsBin.Add(profile);
                 break;
 
             case AHB_WHITE:
-                WhiteItemsBin.insert(itr->second.ItemId);
+                WhiteItemsBin.Add(profile);
                 break;
 
             case AHB_GREEN:
-                GreenItemsBin.insert(itr->second.ItemId);
+                GreenItemsBin.Add(profile);
                 break;
 
             case AHB_BLUE:
-                BlueItemsBin.insert(itr->second.ItemId);
+                BlueItemsBin.Add(profile);
                 break;
 
             case AHB_PURPLE:
-                PurpleItemsBin.insert(itr->second.ItemId);
+                PurpleItemsBin.Add(profile);
                 break;
 
             case AHB_ORANGE:
-                OrangeItemsBin.insert(itr->second.ItemId);
+                OrangeItemsBin.Add(profile);
                 break;
 
             case AHB_YELLOW:
-                YellowItemsBin.insert(itr->second.ItemId);
+                YellowItemsBin.Add(profile);
                 break;
             }
         }
@@ -3341,20 +4068,20 @@ void AHBConfig::InitializeBins()
         {
             LOG_ERROR("module", "AHBot: No items are disabled or in the whitelist! Selling will be disabled!");
 
-            GreyTradeGoodsBin.clear();
-            WhiteTradeGoodsBin.clear();
-            GreenTradeGoodsBin.clear();
-            BlueTradeGoodsBin.clear();
-            PurpleTradeGoodsBin.clear();
-            OrangeTradeGoodsBin.clear();
-            YellowTradeGoodsBin.clear();
-            GreyItemsBin.clear();
-            WhiteItemsBin.clear();
-            GreenItemsBin.clear();
-            BlueItemsBin.clear();
-            PurpleItemsBin.clear();
-            OrangeItemsBin.clear();
-            YellowItemsBin.clear();
+            GreyTradeGoodsBin.Clear();
+            WhiteTradeGoodsBin.Clear();
+            GreenTradeGoodsBin.Clear();
+            BlueTradeGoodsBin.Clear();
+            PurpleTradeGoodsBin.Clear();
+            OrangeTradeGoodsBin.Clear();
+            YellowTradeGoodsBin.Clear();
+            GreyItemsBin.Clear();
+            WhiteItemsBin.Clear();
+            GreenItemsBin.Clear();
+            BlueItemsBin.Clear();
+            PurpleItemsBin.Clear();
+            OrangeItemsBin.Clear();
+            YellowItemsBin.Clear();
 
             AHBSeller = false;
 
@@ -3368,20 +4095,193 @@ void AHBConfig::InitializeBins()
         LOG_INFO("module", "AHBot: Using a whitelist of {} items", uint32(SellerWhiteList.size()));
     }
 
-    LOG_INFO("module", "AHBot: loaded {} grey   trade goods", uint32(GreyTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} white  trade goods", uint32(WhiteTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} green  trade goods", uint32(GreenTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} blue   trade goods", uint32(BlueTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} purple trade goods", uint32(PurpleTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} orange trade goods", uint32(OrangeTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} yellow trade goods", uint32(YellowTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} grey   items"      , uint32(GreyItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} white  items"      , uint32(WhiteItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} green  items"      , uint32(GreenItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} blue   items"      , uint32(BlueItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} purple items"      , uint32(PurpleItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} orange items"      , uint32(OrangeItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} yellow items"      , uint32(YellowItemsBin.size()));
+    //
+    // Exclude from the selection the templates which already reached the duplicates limit in the market
+    //
+
+    if (DuplicatesCount)
+    {
+        for (auto const& templateCount: templatesCount)
+        {
+            if (templateCount.second >= DuplicatesCount)
+            {
+                if (AHBItemBin* bin = getItemBin(templateCount.first))
+                {
+                    bin->SetEligible(templateCount.first, false);
+                }
+            }
+        }
+    }
+
+    LOG_INFO("module", "AHBot: loaded {} grey   trade goods", uint32(GreyTradeGoodsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} white  trade goods", uint32(WhiteTradeGoodsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} green  trade goods", uint32(GreenTradeGoodsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} blue   trade goods", uint32(BlueTradeGoodsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} purple trade goods", uint32(PurpleTradeGoodsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} orange trade goods", uint32(OrangeTradeGoodsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} yellow trade goods", uint32(YellowTradeGoodsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} grey   items"      , uint32(GreyItemsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} white  items"      , uint32(WhiteItemsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} green  items"      , uint32(GreenItemsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} blue   items"      , uint32(BlueItemsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} purple items"      , uint32(PurpleItemsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} orange items"      , uint32(OrangeItemsBin.Size()));
+    LOG_INFO("module", "AHBot: loaded {} yellow items"      , uint32(YellowItemsBin.Size()));
+}
+
+uint64 AHBConfig::initializeRandomEnchantments(ItemTemplate const* prototype)
+{
+    //
+    // Same rules as the core: a template rolls either a random property or a random suffix, never both
+    //
+
+    if ((prototype->RandomProperty == 0) == (prototype->RandomSuffix == 0))
+    {
+        return 0;
+    }
+
+    bool   suffix = prototype->RandomSuffix != 0;
+    uint32 entry  = suffix ? prototype->RandomSuffix : prototype->RandomProperty;
+    uint64 key    = (uint64(entry) << 1) | (suffix ? 1 : 0);
+
+    if (randomEnchantments.find(key) != randomEnchantments.end())
+    {
+        return key;
+    }
+
+    auto rows = randomEnchantRows.find(entry);
+
+    if (rows == randomEnchantRows.end())
+    {
+        return 0;
+    }
+
+    //
+    // Resolve the ids against the stores once, the sampler then only draws among them
+    //
+
+    AHBRandomEnchantments table;
+    std::vector<uint32>   weights;
+
+    for (auto const& row: rows->second)
+    {
+        int32 id = 0;
+
+        if (suffix && sItemRandomSuffixStore.LookupEntry(row.first))
+        {
+            id = -int32(row.first);
+        }
+        else if (!suffix && sItemRandomPropertiesStore.LookupEntry(row.first))
+        {
+            id = int32(row.first);
+        }
+
+        table.Ids.push_back(id);
+        weights.push_back(uint32(std::max(row.second, 0.0f) * 100.0f + 0.5f));
+    }
+
+    table.Sampler.Reset(weights);
+
+    if (table.Sampler.Empty())
+    {
+        return 0;
+    }
+
+    randomEnchantments.emplace(key, std::move(table));
+
+    return key;
+}
+
+void AHBConfig::initializeProfile(AHBItemProfile& profile, ItemTemplate const* prototype)
+{
+    profile.ItemId    = prototype->ItemId;
+    profile.Template  = prototype;
+    profile.Quality   = prototype->Quality;
+    profile.Level     = std::min<uint32>(prototype->RequiredLevel ? prototype->RequiredLevel : prototype->ItemLevel, DEFAULT_MAX_LEVEL);
+
+    profile.RandomEnchantments = initializeRandomEnchantments(prototype);
+    profile.BasePrice = UseBuyPriceForSeller ? prototype->BuyPrice : prototype->SellPrice;
+
+    refreshProfile(profile);
+}
+
+void AHBConfig::refreshProfile(AHBItemProfile& profile)
+{
+    //
+    // Price bands
+    //
+
+    profile.MinPrice    = GetMinPrice   (profile.Quality);
+    profile.MaxPrice    = GetMaxPrice   (profile.Quality);
+    profile.MinBidPrice = GetMinBidPrice(profile.Quality);
+    profile.MaxBidPrice = GetMaxBidPrice(profile.Quality);
+
+    //
+    // Stack size distribution
+    //
+
+    uint32 templateMax = profile.Template->GetMaxStackSize();
+    uint32 qualityMax  = GetMaxStack(profile.Quality);
+
+    profile.StackMax   = 1;
+    profile.StackLimit = 0;
+    profile.StackStep  = 0;
+    profile.StackSteps = 0;
+
+    if (templateMax <= 1 || qualityMax == 1)
+    {
+        return;
+    }
+
+    profile.StackLimit = qualityMax;
+
+    if (DivisibleStacks)
+    {
+        if (templateMax % 3 == 0) // 3, 6, 9
+        {
+            profile.StackStep  = 3;
+            profile.StackSteps = 3;
+        }
+        else if (templateMax % 4 == 0) // 4, 8, 12, 16
+        {
+            profile.StackStep  = 4;
+            profile.StackSteps = 4;
+        }
+        else if (templateMax % 5 == 0) // 5, 10, 15, 20
+        {
+            profile.StackStep  = 5;
+            profile.StackSteps = 4;
+        }
+    }
+
+    if (profile.StackStep == 0 && StackSizeCap != 0)
+    {
+        profile.StackMax = std::min(templateMax, StackSizeCap);
+    }
+    else
+    {
+        profile.StackMax = templateMax;
+    }
+}
+
+void AHBConfig::refreshProfiles(uint32 color)
+{
+    if (color > AHB_MAX_QUALITY)
+    {
+        return;
+    }
+
+    profilesVersion++;
+
+    for (AHBItemProfile& profile: GetBin(color).GetProfiles())
+    {
+        refreshProfile(profile);
+    }
+
+    for (AHBItemProfile& profile: GetBin(color + 7).GetProfiles())
+    {
+        refreshProfile(profile);
+    }
 }
 
 std::set<uint32> AHBConfig::getCommaSeparatedIntegers(std::string text)
@@ -3404,9 +4304,30 @@ std::set<uint32> AHBConfig::getCommaSeparatedIntegers(std::string text)
     return ret;
 }
 
-std::set<uint32> &AHBConfig::GetBin(uint32 itemType)
+AHBItemBin* AHBConfig::getItemBin(uint32 id)
+{
+    ItemTemplate const* prototype = sObjectMgr->GetItemTemplate(id);
+
+    if (!prototype || prototype->Quality > AHB_MAX_QUALITY)
+    {
+        return nullptr;
+    }
+
+    //
+    // Same classification used for the items count
+    //
+
+    if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
+    {
+        return &GetBin(prototype->Quality);
+    }
+
+    return &GetBin(prototype->Quality + 7);
+}
+
+AHBItemBin &AHBConfig::GetBin(uint32 itemType)
 {
-    static const std::map<uint32, std::set<uint32> AHBConfig::*> binMap = {
+    static const std::map<uint32, AHBItemBin AHBConfig::*> binMap = {
         {AHB_GREY_TG, &AHBConfig::GreyTradeGoodsBin},
         {AHB_WHITE_TG, &AHBConfig::WhiteTradeGoodsBin},
         {AHB_GREEN_TG, &AHBConfig::GreenTradeGoodsBin},
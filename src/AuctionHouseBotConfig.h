@@ -23,9 +23,28 @@
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "ObjectMgr.h"
 
+#include "AuctionHouseBotItemBin.h"
+#include "AuctionHouseBotSampler.h"
+
+struct AuctionEntry;
+struct AuctionHouseEntry;
+class  Item;
+
+//
+// Random properties or suffixes an item_enchantment_template entry can roll, with their chances
+//
+
+struct AHBRandomEnchantments
+{
+    std::vector<int32> Ids;     // Ready for SetItemRandomProperties: negative for the suffixes, 0 for the invalid ones
+    AHBWeightedSampler Sampler; // Chances of the ids, in hundredths of percent
+};
+
 class AHBConfig
 {
 private:
@@ -35,6 +54,22 @@ private:
     uint32 minItems;
     uint32 maxItems;
 
+    uint32 populationFactor; // Percent of minItems and maxItems in use, depending on the online players
+
+    //
+    // Measured cost of browsing the market, and the amount of auctions it allows
+    //
+
+    double browseCost;       // Smoothed, in nanoseconds per auction
+    uint32 browseCap;        // 0 when not measured yet or disabled
+    time_t nextBrowseProbe;
+
+    //
+    // Levels of the players online which can use this auction house
+    //
+
+    std::vector<uint8> playerLevels;
+
     uint32 percentGreyTradeGoods;
     uint32 percentWhiteTradeGoods;
     uint32 percentGreenTradeGoods;
@@ -151,11 +186,75 @@ private:
     std::map<uint32, uint64> itemsSum;
     std::map<uint32, uint64> itemsPrice;
 
+    //
+    // Live auctions per item template, kept updated by the auction house hooks
+    //
+
+    std::unordered_map<uint32, uint32> templatesCount;
+
+    //
+    // Live auctions owned by the bots, kept updated by the auction house hooks
+    //
+
+    uint32                             botAuctionsTotal;
+    std::unordered_map<uint32, uint32> botExpiryCount;   // Expiry bucket -> bot auctions expiring in it
+    std::set<std::pair<time_t, uint32>> botExpiryIndex;  // (Expiry time, auction id) of the bot auctions
+
+    void   addBotExpiry(uint32 auctionId, time_t expireTime);
+    void   removeBotExpiry(uint32 auctionId, time_t expireTime);
+
+    //
+    // Changes whenever the listing profiles are rebuilt or refreshed
+    //
+
+    uint32 profilesVersion;
+
+    //
+    // Consumption of the auctions per category, for the predictive replenishment
+    //
+
+    std::vector<uint32> consumedCounts;   // Sold or expired since the last evaluation
+    std::vector<double> consumptionRates; // Smoothed, in auctions per second
+    std::vector<double> replenishCredits; // Fractions of auctions not listed yet
+    std::vector<uint32> pendingQuotas;    // Evaluated, but not claimed by a bot yet
+    time_t              lastReplenish;
+
+    void   evaluateReplenishQuotas(time_t now);
+
+    //
+    // Plan of the current selling round, shared by the bots when sharding
+    //
+
+    uint32              sellRoundAuctions; // Auctions not taken by a bot yet
+    std::vector<uint32> sellRoundMissing;  // Missing counts not taken by a bot yet
+
     void   InitializeFromFile();
     void   InitializeFromSql(std::set<uint32> botsIds);
+    void   InitializeBotAuctions(std::set<uint32> botsIds);
 
     std::set<uint32> getCommaSeparatedIntegers(std::string text);
 
+    AHBItemBin* getItemBin(uint32 id);
+
+    //
+    // Rows of item_enchantment_template, and the tables built from them for the binned templates
+    //
+
+    std::unordered_map<uint32, std::vector<std::pair<uint32, float>>> randomEnchantRows;
+    std::unordered_map<uint64, AHBRandomEnchantments>                 randomEnchantments; // (Entry << 1) | suffix -> table
+
+    uint64 initializeRandomEnchantments(ItemTemplate const* prototype);
+
+    //
+    // Deposits already computed, per (template, 12 hours duration bucket, stack size)
+    //
+
+    std::unordered_map<uint64, uint32> depositCache;
+
+    void   initializeProfile(AHBItemProfile& profile, ItemTemplate const* prototype);
+    void   refreshProfile(AHBItemProfile& profile);
+    void   refreshProfiles(uint32 color);
+
 public:
     //
     // Debugging
@@ -187,6 +286,27 @@ public:
     bool   ConsiderOnlyBotAuctions;
     uint32 ItemsPerCycle;
     uint32 StackSizeCap;
+    uint32 SellerBatchSize;
+    uint32 SellerBulkInsert;
+
+    bool   PopulationScaling;
+    uint32 PopulationFull;
+    float  PopulationCurve;
+    uint32 PopulationMinFactor;
+    uint32 PopulationHysteresis;
+
+    bool   BrowseCostCap;
+    uint32 BrowseTargetLatency;
+    uint32 BrowseProbeInterval;
+
+    bool   LevelTargeting;
+    uint32 LevelRangeBelow;
+    uint32 LevelRangeAbove;
+    uint32 SellerReplenishMode;
+    uint32 SellerRateHalfLife;
+    uint32 SellerReplenishTime;
+    bool   SellerSharding;
+    uint32 SellerInterval;
 
     //
     // Filters
@@ -207,6 +327,9 @@ public:
 
     uint32 DuplicatesCount;
     uint32 ElapsingTimeClass;
+    bool   SmoothExpiryTimes;
+    bool   RelistExpired;
+    bool   RelistReprice;
 
     bool   DivisibleStacks;
     bool   DisablePermEnchant;
@@ -265,28 +388,28 @@ public:
     std::set<uint32> SellerWhiteList;
 
     //
-    // Bins for trade goods.
+    // Bins for trade goods
     //
 
-    std::set<uint32> GreyTradeGoodsBin;
-    std::set<uint32> WhiteTradeGoodsBin;
-    std::set<uint32> GreenTradeGoodsBin;
-    std::set<uint32> BlueTradeGoodsBin;
-    std::set<uint32> PurpleTradeGoodsBin;
-    std::set<uint32> OrangeTradeGoodsBin;
-    std::set<uint32> YellowTradeGoodsBin;
+    AHBItemBin GreyTradeGoodsBin;
+    AHBItemBin WhiteTradeGoodsBin;
+    AHBItemBin GreenTradeGoodsBin;
+    AHBItemBin BlueTradeGoodsBin;
+    AHBItemBin PurpleTradeGoodsBin;
+    AHBItemBin OrangeTradeGoodsBin;
+    AHBItemBin YellowTradeGoodsBin;
 
     //
     // Bins for items
     //
 
-    std::set<uint32> GreyItemsBin;
-    std::set<uint32> WhiteItemsBin;
-    std::set<uint32> GreenItemsBin;
-    std::set<uint32> BlueItemsBin;
-    std::set<uint32> PurpleItemsBin;
-    std::set<uint32> OrangeItemsBin;
-    std::set<uint32> YellowItemsBin;
+    AHBItemBin GreyItemsBin;
+    AHBItemBin WhiteItemsBin;
+    AHBItemBin GreenItemsBin;
+    AHBItemBin BlueItemsBin;
+    AHBItemBin PurpleItemsBin;
+    AHBItemBin OrangeItemsBin;
+    AHBItemBin YellowItemsBin;
 
     //
     // Constructors/destructors
@@ -314,6 +437,13 @@ public:
     void   SetMaxItems       (uint32 value);
     uint32 GetMaxItems       ();
 
+    void   UpdatePopulation  (uint32 players);
+
+    void   UpdateBrowseCost  (time_t now);
+
+    void   SetPlayerLevels   (std::vector<uint8> const& levels);
+    uint32 GetRandomPlayerLevel();
+
     void   SetPercentages    (uint32 greytg, uint32 whitetg, uint32 greentg, uint32 bluetg, uint32 purpletg, uint32 orangetg, uint32 yellowtg,
                               uint32 greyi , uint32 whitei , uint32 greeni , uint32 bluei , uint32 purplei , uint32 orangei , uint32 yellowi);
     uint32 GetPercentages    (uint32 color);
@@ -359,7 +489,35 @@ public:
     void   UpdateItemStats   (uint32 id, uint32 stackSize, uint64 buyout);
     uint64 GetItemPrice      (uint32 id);
 
-    std::set<uint32>& GetBin(uint32 itemType);
+    void   IncTemplateCount  (uint32 id);
+    void   DecTemplateCount  (uint32 id);
+
+    void   IncBotAuctions    (AuctionEntry const* auction);
+    void   DecBotAuctions    (AuctionEntry const* auction);
+    uint32 GetBotAuctions    ();
+    uint32 GetBotExpiries    (time_t expireTime);
+
+    std::vector<std::pair<time_t, uint32>> GetExpiringBotAuctions(time_t expireTime);
+    time_t GetNextBotExpiry  ();
+    void   RescheduleBotAuction(AuctionEntry* auction, time_t expireTime);
+    void   ExpireBotAuction  (AuctionEntry* auction, time_t expireTime);
+    void   SkipBotAuction    (uint32 auctionId, time_t expireTime);
+
+    AHBItemProfile const* GetItemProfile(uint32 id);
+    int32  GetRandomPropertyId(AHBItemProfile const* profile);
+    uint32 GetAuctionDeposit (AuctionHouseEntry const* ahEntry, uint32 etime, Item* item, uint32 stackCount);
+
+    uint32 GetProfilesVersion();
+
+    void   IncConsumedCounts (uint32 Class, uint32 Quality);
+    std::vector<uint32> GetReplenishQuotas(time_t now, std::vector<uint32> const& limits, uint32 total);
+    bool   IsReplenishDue    (time_t now);
+
+    void   SetSellRound      (uint32 auctions, std::vector<uint32> const& missing);
+    bool   TakeSellRoundShare(uint32 shares, uint32& auctions, std::vector<uint32>& missing);
+    bool   HasSellRoundShare ();
+
+    AHBItemBin& GetBin(uint32 itemType);
 };
 
 //
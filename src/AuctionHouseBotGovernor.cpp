@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <algorithm>
+
+#include "AuctionHouseBotGovernor.h"
+
+AHBGovernor::AHBGovernor()
+{
+    _enabled      = false;
+    _targetDiff   = 100;
+    _minShare     = 10;
+    _increase     = 5;
+    _decrease     = 0.5f;
+
+    _lastDiff     = 0;
+    _smoothedDiff = 0;
+    _share        = 1.0;
+    _elapsed      = 0;
+
+    _decreases    = 0;
+    _increases    = 0;
+}
+
+void AHBGovernor::Configure(bool enabled, uint32 targetDiff, uint32 minShare, uint32 increase, float decrease)
+{
+    _enabled    = enabled;
+    _targetDiff = targetDiff;
+    _minShare   = std::min(minShare, 100u);
+    _increase   = increase;
+    _decrease   = std::clamp(decrease, 0.0f, 1.0f);
+
+    //
+    // Start over from the whole work when the settings change
+    //
+
+    _share      = 1.0;
+    _elapsed    = 0;
+    _decreases  = 0;
+    _increases  = 0;
+}
+
+void AHBGovernor::Update(uint32 diff)
+{
+    _lastDiff     = diff;
+    _smoothedDiff = _smoothedDiff == 0 ? diff : _smoothedDiff + 0.2 * (diff - _smoothedDiff);
+
+    if (!_enabled || _targetDiff == 0)
+    {
+        _share = 1.0;
+        return;
+    }
+
+    //
+    // Evaluate once per second of world time, whatever the update rate
+    //
+
+    _elapsed += diff;
+
+    if (_elapsed < IN_MILLISECONDS)
+    {
+        return;
+    }
+
+    _elapsed = 0;
+
+    double minShare = _minShare / 100.0;
+
+    if (_smoothedDiff > _targetDiff)
+    {
+        _share = std::max(minShare, _share * _decrease);
+        _decreases++;
+    }
+    else if (_share < 1.0)
+    {
+        _share = std::min(1.0, _share + _increase / 100.0);
+        _increases++;
+    }
+}
+
+uint32 AHBGovernor::Scale(uint32 amount) const
+{
+    //
+    // Never scale some work down to nothing, the bots would stop entirely
+    //
+
+    if (amount == 0)
+    {
+        return 0;
+    }
+
+    return std::max(1u, uint32(amount * _share + 0.5));
+}
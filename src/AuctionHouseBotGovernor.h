@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_GOVERNOR_H
+#define AUCTION_HOUSE_BOT_GOVERNOR_H
+
+#include "Common.h"
+
+// =============================================================================
+// Throttling of the bots work depending on the server load.
+//
+// The world update diff is smoothed and compared to a target once per second:
+// above it, the share of work the bots perform is cut by a factor, below it the
+// share grows back by a fixed step (additive increase, multiplicative decrease).
+// The amounts of auctions created and of bids placed are scaled by the share.
+// =============================================================================
+
+class AHBGovernor
+{
+private:
+    bool   _enabled;
+    uint32 _targetDiff;  // Milliseconds
+    uint32 _minShare;    // Percent
+    uint32 _increase;    // Percent points per healthy evaluation
+    float  _decrease;    // Share multiplier per overloaded evaluation
+
+    uint32 _lastDiff;
+    double _smoothedDiff;
+    double _share;       // Of the work, between _minShare and 1
+    uint32 _elapsed;     // Since the last evaluation, in milliseconds
+
+    uint32 _decreases;
+    uint32 _increases;
+
+public:
+    AHBGovernor();
+
+    void   Configure(bool enabled, uint32 targetDiff, uint32 minShare, uint32 increase, float decrease);
+    void   Update(uint32 diff);
+
+    uint32 Scale(uint32 amount) const;
+
+    bool   IsEnabled() const       { return _enabled; };
+    uint32 GetTargetDiff() const   { return _targetDiff; };
+    uint32 GetLastDiff() const     { return _lastDiff; };
+    uint32 GetSmoothedDiff() const { return uint32(_smoothedDiff); };
+    uint32 GetShare() const        { return uint32(_share * 100.0 + 0.5); };
+    uint32 GetDecreases() const    { return _decreases; };
+    uint32 GetIncreases() const    { return _increases; };
+};
+
+//
+// Governor shared by all the bots
+//
+
+extern AHBGovernor* gGovernor;
+
+#endif // AUCTION_HOUSE_BOT_GOVERNOR_H
@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <algorithm>
+
+#include "Random.h"
+
+#include "AuctionHouseBotItemBin.h"
+
+uint32 AHBItemProfile::GetRandomStackCount() const
+{
+    if (StackMax <= 1)
+    {
+        return 1;
+    }
+
+    uint32 ret = 0;
+
+    if (StackStep)
+    {
+        //
+        // Organize the stacks in a pseudo random way
+        //
+
+        ret = std::min(urand(1, StackSteps) * StackStep, StackMax);
+    }
+    else
+    {
+        //
+        // More likely to be a whole stack.
+        //
+
+        bool wholeStack = frand(0, 1) > 0.35; // TODO: Get this from config
+        ret = wholeStack ? StackMax : urand(1, StackMax);
+    }
+
+    if (StackLimit && ret > StackLimit)
+    {
+        ret = StackLimit;
+    }
+
+    return ret;
+}
+
+AHBItemBin::AHBItemBin()
+{
+    _eligible    = 0;
+    _levelsDirty = false;
+}
+
+void AHBItemBin::Clear()
+{
+    _profiles.clear();
+    _items.clear();
+    _positions.clear();
+
+    _levels.clear();
+    _levelItems.clear();
+    _levelEligible.clear();
+    _levelTree.clear();
+    _levelSlots.clear();
+
+    _eligible    = 0;
+    _levelsDirty = false;
+}
+
+void AHBItemBin::swapItems(uint32 a, uint32 b)
+{
+    if (a == b)
+    {
+        return;
+    }
+
+    std::swap(_items[a], _items[b]);
+
+    _positions[_profiles[_items[a]].ItemId] = a;
+    _positions[_profiles[_items[b]].ItemId] = b;
+}
+
+void AHBItemBin::Add(AHBItemProfile const& profile)
+{
+    if (Contains(profile.ItemId))
+    {
+        return;
+    }
+
+    //
+    // New templates are eligible: append and move to the end of the eligible partition
+    //
+
+    _profiles.push_back(profile);
+
+    _items.push_back(_profiles.size() - 1);
+    _positions[profile.ItemId] = _items.size() - 1;
+
+    swapItems(_eligible, _items.size() - 1);
+    _eligible++;
+
+    _levelsDirty = true;
+}
+
+bool AHBItemBin::Contains(uint32 id) const
+{
+    return _positions.find(id) != _positions.end();
+}
+
+bool AHBItemBin::IsEligible(uint32 id) const
+{
+    auto it = _positions.find(id);
+
+    if (it == _positions.end())
+    {
+        return false;
+    }
+
+    return it->second < _eligible;
+}
+
+void AHBItemBin::SetEligible(uint32 id, bool eligible)
+{
+    auto it = _positions.find(id);
+
+    if (it == _positions.end())
+    {
+        return;
+    }
+
+    uint32 position = it->second;
+
+    if (eligible && position >= _eligible)
+    {
+        swapItems(position, _eligible);
+        _eligible++;
+    }
+    else if (!eligible && position < _eligible)
+    {
+        _eligible--;
+        swapItems(position, _eligible);
+    }
+    else
+    {
+        return;
+    }
+
+    //
+    // Once built, the level index follows the same moves
+    //
+
+    if (!_levelsDirty)
+    {
+        setLevelEligible(_items[it->second], eligible);
+    }
+}
+
+AHBItemProfile const* AHBItemBin::GetProfile(uint32 id) const
+{
+    auto it = _positions.find(id);
+
+    if (it == _positions.end())
+    {
+        return nullptr;
+    }
+
+    return &_profiles[_items[it->second]];
+}
+
+AHBItemProfile const* AHBItemBin::GetRandomProfile() const
+{
+    if (_eligible == 0)
+    {
+        return nullptr;
+    }
+
+    return &_profiles[_items[urand(0, _eligible - 1)]];
+}
+
+AHBItemProfile const* AHBItemBin::GetRandomProfile(uint32 minLevel, uint32 maxLevel)
+{
+    if (_eligible == 0)
+    {
+        return nullptr;
+    }
+
+    if (_levelsDirty)
+    {
+        buildLevels();
+    }
+
+    //
+    // Locate the levels of the range, then draw among their eligible templates: the draw
+    // is a rank over the whole index, found back in the tree
+    //
+
+    uint32 first = std::lower_bound(_levels.begin(), _levels.end(), minLevel) - _levels.begin();
+    uint32 last  = std::upper_bound(_levels.begin(), _levels.end(), maxLevel) - _levels.begin();
+
+    if (first >= last)
+    {
+        return nullptr;
+    }
+
+    uint32 before = countLevels(first);
+    uint32 count  = countLevels(last) - before;
+
+    if (count == 0)
+    {
+        return nullptr;
+    }
+
+    uint32 rank  = before + urand(0, count - 1);
+    uint32 level = findLevel(rank);
+
+    return &_profiles[_levelItems[level][rank]];
+}
+
+void AHBItemBin::buildLevels()
+{
+    _levels.clear();
+
+    for (AHBItemProfile const& profile: _profiles)
+    {
+        _levels.push_back(profile.Level);
+    }
+
+    std::sort(_levels.begin(), _levels.end());
+    _levels.erase(std::unique(_levels.begin(), _levels.end()), _levels.end());
+
+    _levelItems.assign(_levels.size(), std::vector<uint32>());
+    _levelEligible.assign(_levels.size(), 0);
+    _levelTree.assign(_levels.size() + 1, 0);
+    _levelSlots.assign(_profiles.size(), 0);
+
+    for (uint32 i = 0; i < _profiles.size(); ++i)
+    {
+        _levelItems[getLevel(i)].push_back(i);
+    }
+
+    //
+    // Partition every level like the bin itself
+    //
+
+    for (uint32 level = 0; level < _levelItems.size(); ++level)
+    {
+        std::vector<uint32>& items = _levelItems[level];
+
+        auto middle = std::partition(items.begin(), items.end(), [this](uint32 profile)
+        {
+            return IsEligible(_profiles[profile].ItemId);
+        });
+
+        _levelEligible[level] = middle - items.begin();
+
+        for (uint32 slot = 0; slot < items.size(); ++slot)
+        {
+            _levelSlots[items[slot]] = slot;
+        }
+
+        addLevelCount(level, _levelEligible[level]);
+    }
+
+    _levelsDirty = false;
+}
+
+uint32 AHBItemBin::getLevel(uint32 profile) const
+{
+    return std::lower_bound(_levels.begin(), _levels.end(), _profiles[profile].Level) - _levels.begin();
+}
+
+void AHBItemBin::swapLevelItems(uint32 level, uint32 a, uint32 b)
+{
+    if (a == b)
+    {
+        return;
+    }
+
+    std::vector<uint32>& items = _levelItems[level];
+
+    std::swap(items[a], items[b]);
+
+    _levelSlots[items[a]] = a;
+    _levelSlots[items[b]] = b;
+}
+
+void AHBItemBin::setLevelEligible(uint32 profile, bool eligible)
+{
+    uint32 level = getLevel(profile);
+    uint32 slot  = _levelSlots[profile];
+
+    if (eligible && slot >= _levelEligible[level])
+    {
+        swapLevelItems(level, slot, _levelEligible[level]);
+        _levelEligible[level]++;
+        addLevelCount(level, 1);
+    }
+    else if (!eligible && slot < _levelEligible[level])
+    {
+        _levelEligible[level]--;
+        swapLevelItems(level, slot, _levelEligible[level]);
+        addLevelCount(level, -1);
+    }
+}
+
+void AHBItemBin::addLevelCount(uint32 level, int32 delta)
+{
+    for (uint32 i = level + 1; i < _levelTree.size(); i += i & (0u - i))
+    {
+        _levelTree[i] += delta;
+    }
+}
+
+uint32 AHBItemBin::countLevels(uint32 levels) const
+{
+    uint32 count = 0;
+
+    for (uint32 i = levels; i > 0; i -= i & (0u - i))
+    {
+        count += _levelTree[i];
+    }
+
+    return count;
+}
+
+uint32 AHBItemBin::findLevel(uint32& rank) const
+{
+    //
+    // Descend the tree to the level holding the given rank, which is left relative to that level
+    //
+
+    uint32 size  = _levelTree.size() - 1;
+    uint32 level = 0;
+    uint32 step  = 1;
+
+    while (step * 2 <= size)
+    {
+        step *= 2;
+    }
+
+    for (; step > 0; step /= 2)
+    {
+        if (level + step <= size && _levelTree[level + step] <= rank)
+        {
+            level += step;
+            rank  -= _levelTree[level];
+        }
+    }
+
+    return level;
+}
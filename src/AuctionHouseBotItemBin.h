@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_ITEM_BIN_H
+#define AUCTION_HOUSE_BOT_ITEM_BIN_H
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Common.h"
+
+struct ItemTemplate;
+
+// =============================================================================
+// Everything the seller needs to list a template, computed once when the bins
+// are built instead of for every single auction.
+// =============================================================================
+
+struct AHBItemProfile
+{
+    uint32              ItemId;
+    ItemTemplate const* Template;
+    uint32              Quality;
+    uint32              Level;       // Required level, or the item level for the templates without requirements
+    uint64              RandomEnchantments; // Key of the random properties or suffixes table, 0 for none
+
+    uint64              BasePrice;   // Buy or sell price of the template, depending on the configuration
+    uint32              MinPrice;    // Buyout band, in percent of the base price
+    uint32              MaxPrice;
+    uint32              MinBidPrice; // Starting bid band, in percent of the buyout
+    uint32              MaxBidPrice;
+
+    uint32              StackMax;    // Largest stack generated, 1 when the template is not stacked
+    uint32              StackLimit;  // Per quality limit applied on top of the generated size, 0 for none
+    uint32              StackStep;   // With divisible stacks, the size is a multiple of this step (0 otherwise)
+    uint32              StackSteps;  // ... up to this many steps
+
+    uint32              GetRandomStackCount() const;
+};
+
+// =============================================================================
+// Set of item templates the seller can pick from.
+//
+// The templates are stored contiguously and partitioned in two: the eligible
+// ones first, then the ones that reached the duplicates limit in the market.
+// Moving a template between the partitions is a single swap, so a random
+// pick among the eligible templates is always performed in constant time.
+// The profiles themselves never move, so they can be referenced safely while
+// the partitions change.
+//
+// A second index groups the templates per level, every group partitioned the
+// same way, and keeps the eligible counts of the levels in a Fenwick tree: a
+// pick among the eligible templates fitting a level range is performed in
+// logarithmic time, and never returns a template over the duplicates limit.
+// =============================================================================
+
+class AHBItemBin
+{
+private:
+    std::vector<AHBItemProfile>        _profiles;  // In insertion order
+    std::vector<uint32>                _items;     // Profile indexes: eligible templates in [0, _eligible), the others after
+    std::unordered_map<uint32, uint32> _positions; // Template -> index in _items
+    uint32                             _eligible;
+
+    std::vector<uint32>              _levels;        // Distinct levels, sorted
+    std::vector<std::vector<uint32>> _levelItems;    // Profile indexes per level: eligible templates first, the others after
+    std::vector<uint32>              _levelEligible; // Eligible templates per level
+    std::vector<uint32>              _levelTree;     // Fenwick tree of the eligible templates per level
+    std::vector<uint32>              _levelSlots;    // Profile index -> position in the templates of its level
+    bool                             _levelsDirty;   // Built again on the first pick after an addition
+
+    void   swapItems(uint32 a, uint32 b);
+
+    void   buildLevels();
+    uint32 getLevel(uint32 profile) const;
+    void   swapLevelItems(uint32 level, uint32 a, uint32 b);
+    void   setLevelEligible(uint32 profile, bool eligible);
+    void   addLevelCount(uint32 level, int32 delta);
+    uint32 countLevels(uint32 levels) const;
+    uint32 findLevel(uint32& rank) const;
+
+public:
+    AHBItemBin();
+
+    void   Clear();
+    void   Add(AHBItemProfile const& profile);
+
+    bool   Contains(uint32 id) const;
+    bool   IsEligible(uint32 id) const;
+    void   SetEligible(uint32 id, bool eligible);
+
+    uint32 Size() const { return _items.size(); };
+    uint32 EligibleCount() const { return _eligible; };
+
+    AHBItemProfile const* GetProfile(uint32 id) const;
+    AHBItemProfile const* GetRandomProfile() const;
+    AHBItemProfile const* GetRandomProfile(uint32 minLevel, uint32 maxLevel);
+
+    std::vector<AHBItemProfile>& GetProfiles() { return _profiles; };
+};
+
+#endif // AUCTION_HOUSE_BOT_ITEM_BIN_H
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <chrono>
+
+#include "Log.h"
+#include "Random.h"
+
+#include "AuctionHouseBotConfig.h"
+#include "AuctionHouseBotPlanner.h"
+
+// =============================================================================
+// Single producer, single consumer queue
+// =============================================================================
+
+AHBSpecQueue::AHBSpecQueue(uint32 capacity) : _buffer(capacity + 1)
+{
+    _head = 0;
+    _tail = 0;
+}
+
+bool AHBSpecQueue::Push(AHBListingSpec const& spec)
+{
+    uint32 tail = _tail.load(std::memory_order_relaxed);
+    uint32 next = (tail + 1) % _buffer.size();
+
+    if (next == _head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    _buffer[tail] = spec;
+    _tail.store(next, std::memory_order_release);
+
+    return true;
+}
+
+bool AHBSpecQueue::Pop(AHBListingSpec& spec)
+{
+    uint32 head = _head.load(std::memory_order_relaxed);
+
+    if (head == _tail.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    spec = _buffer[head];
+    _head.store((head + 1) % _buffer.size(), std::memory_order_release);
+
+    return true;
+}
+
+// =============================================================================
+// Planner
+// =============================================================================
+
+AHBPlanner::AHBPlanner()
+{
+    _running = false;
+}
+
+AHBPlanner::~AHBPlanner()
+{
+    Stop();
+}
+
+void AHBPlanner::Start(std::vector<AHBConfig*> const& configs, uint32 queueSize)
+{
+    Stop();
+
+    if (queueSize == 0)
+    {
+        return;
+    }
+
+    //
+    // The houses and their queues are set up before the thread exists, and never change while it runs
+    //
+
+    _houses.clear();
+
+    for (AHBConfig* config: configs)
+    {
+        House& house = _houses[config->GetAHID()];
+
+        house.Config           = config;
+        house.PublishedVersion = 0;
+        house.Source           = nullptr;
+
+        for (uint32 i = 0; i < AHB_CATEGORIES; ++i)
+        {
+            house.Queues[i] = std::make_unique<AHBSpecQueue>(queueSize);
+        }
+
+        Publish(config);
+    }
+
+    _running = true;
+    _thread  = std::thread(&AHBPlanner::run, this);
+
+    LOG_INFO("module", "AHBot: Seller planner started, {} listings queued per category", queueSize);
+}
+
+void AHBPlanner::Stop()
+{
+    if (!_thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _running = false;
+    }
+
+    _wake.notify_all();
+    _thread.join();
+
+    LOG_INFO("module", "AHBot: Seller planner stopped");
+}
+
+void AHBPlanner::Publish(AHBConfig* config)
+{
+    auto it = _houses.find(config->GetAHID());
+
+    if (it == _houses.end())
+    {
+        return;
+    }
+
+    House& house = it->second;
+
+    if (house.Source && house.PublishedVersion == config->GetProfilesVersion())
+    {
+        return;
+    }
+
+    //
+    // Copy the profiles on the world thread, then hand them over to the planner
+    //
+
+    std::shared_ptr<Snapshot> source = std::make_shared<Snapshot>();
+
+    source->Version = config->GetProfilesVersion();
+
+    for (uint32 i = 0; i < AHB_CATEGORIES; ++i)
+    {
+        source->Categories[i] = config->GetBin(i).GetProfiles();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_sourceMutex);
+        house.Source = source;
+    }
+
+    house.PublishedVersion = source->Version;
+}
+
+bool AHBPlanner::Pop(AHBConfig* config, uint32 category, AHBListingSpec& spec)
+{
+    auto it = _houses.find(config->GetAHID());
+
+    if (it == _houses.end() || category >= AHB_CATEGORIES)
+    {
+        return false;
+    }
+
+    AHBSpecQueue& queue   = *it->second.Queues[category];
+    AHBItemBin&   bin     = config->GetBin(category);
+    uint32        version = config->GetProfilesVersion();
+
+    //
+    // Throw away what has been planned on outdated profiles or can not be sold anymore
+    //
+
+    for (uint32 attempts = queue.Capacity(); attempts > 0; --attempts)
+    {
+        if (!queue.Pop(spec))
+        {
+            return false;
+        }
+
+        if (spec.Version == version && bin.IsEligible(spec.ItemId))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool AHBPlanner::plan(House& house)
+{
+    std::shared_ptr<Snapshot const> source;
+
+    {
+        std::lock_guard<std::mutex> lock(_sourceMutex);
+        source = house.Source;
+    }
+
+    if (!source)
+    {
+        return false;
+    }
+
+    bool planned = false;
+
+    for (uint32 i = 0; i < AHB_CATEGORIES && _running; ++i)
+    {
+        std::vector<AHBItemProfile> const& profiles = source->Categories[i];
+
+        if (profiles.empty())
+        {
+            continue;
+        }
+
+        for (;;)
+        {
+            AHBItemProfile const& profile = profiles[urand(0, profiles.size() - 1)];
+
+            AHBListingSpec spec;
+
+            spec.ItemId     = profile.ItemId;
+            spec.Version    = source->Version;
+            spec.BuyoutRate = urand(profile.MinPrice, profile.MaxPrice);
+            spec.BidRate    = urand(profile.MinBidPrice, profile.MaxBidPrice);
+            spec.StackCount = profile.GetRandomStackCount();
+
+            if (!house.Queues[i]->Push(spec))
+            {
+                break;
+            }
+
+            planned = true;
+        }
+    }
+
+    return planned;
+}
+
+void AHBPlanner::run()
+{
+    while (_running)
+    {
+        bool planned = false;
+
+        for (auto& house: _houses)
+        {
+            planned |= plan(house.second);
+        }
+
+        //
+        // Every queue is full: give the world thread some time to consume the listings
+        //
+
+        if (!planned)
+        {
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wake.wait_for(lock, std::chrono::milliseconds(100), [this] { return !_running; });
+        }
+    }
+}
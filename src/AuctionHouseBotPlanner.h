@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_PLANNER_H
+#define AUCTION_HOUSE_BOT_PLANNER_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common.h"
+
+#include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotItemBin.h"
+
+class AHBConfig;
+
+//
+// Listing prepared by the planner, ready to be minted by the world thread
+//
+
+struct AHBListingSpec
+{
+    uint32 ItemId;
+    uint32 Version;    // Profiles version the spec has been computed on
+    uint32 BuyoutRate; // Percent of the base price
+    uint32 BidRate;    // Percent of the buyout
+    uint32 StackCount;
+};
+
+// =============================================================================
+// Bounded lock-free queue with a single producer and a single consumer.
+//
+// The producer only writes the tail and the consumer only writes the head, so
+// the two sides never wait on each other: a full queue rejects the push and an
+// empty one rejects the pop.
+// =============================================================================
+
+class AHBSpecQueue
+{
+private:
+    std::vector<AHBListingSpec> _buffer;
+
+    alignas(64) std::atomic<uint32> _head; // Next slot to read, owned by the consumer
+    alignas(64) std::atomic<uint32> _tail; // Next slot to write, owned by the producer
+
+public:
+    explicit AHBSpecQueue(uint32 capacity);
+
+    bool   Push(AHBListingSpec const& spec);
+    bool   Pop(AHBListingSpec& spec);
+
+    uint32 Capacity() const { return _buffer.size() - 1; };
+};
+
+// =============================================================================
+// Background generation of the listings.
+//
+// The CPU-only part of the selling (item pick, price rates and stack size) is
+// performed by a dedicated thread, which keeps a queue of ready listings filled
+// for every category of every auction house. The planner works on a copy of the
+// listing profiles, published by the world thread whenever they change; what
+// it cannot see, like the duplicates limit, is checked again when popping.
+// =============================================================================
+
+class AHBPlanner
+{
+private:
+    struct Snapshot
+    {
+        uint32                                                          Version;
+        std::array<std::vector<AHBItemProfile>, AHB_CATEGORIES> Categories;
+    };
+
+    struct House
+    {
+        AHBConfig*                                                      Config;
+        uint32                                                          PublishedVersion; // World thread only
+        std::shared_ptr<Snapshot const>                                 Source;           // Guarded by _sourceMutex
+        std::array<std::unique_ptr<AHBSpecQueue>, AHB_CATEGORIES> Queues;
+    };
+
+    std::map<uint32, House> _houses; // Per auction house id; fixed while the thread runs
+
+    std::mutex              _sourceMutex;
+    std::mutex              _wakeMutex;
+    std::condition_variable _wake;
+    std::thread             _thread;
+    std::atomic<bool>       _running;
+
+    void   run();
+    bool   plan(House& house);
+
+public:
+    AHBPlanner();
+    ~AHBPlanner();
+
+    void   Start(std::vector<AHBConfig*> const& configs, uint32 queueSize);
+    void   Stop();
+    bool   IsRunning() const { return _running; };
+
+    void   Publish(AHBConfig* config);
+    bool   Pop(AHBConfig* config, uint32 category, AHBListingSpec& spec);
+};
+
+//
+// Planner shared by all the bots
+//
+
+extern AHBPlanner* gPlanner;
+
+#endif // AUCTION_HOUSE_BOT_PLANNER_H
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <stdexcept>
+
+#include "Random.h"
+
+#include "AuctionHouseBotSampler.h"
+
+AHBWeightedSampler::AHBWeightedSampler()
+{
+    _total         = 0;
+    _snapshotTotal = 0;
+}
+
+void AHBWeightedSampler::Reset(std::vector<uint32> const& weights)
+{
+    _weights = weights;
+    _total   = 0;
+
+    for (uint32 weight: _weights)
+    {
+        _total += weight;
+    }
+
+    Rebuild();
+}
+
+void AHBWeightedSampler::Rebuild()
+{
+    //
+    // Take the snapshot of the current weights
+    //
+
+    uint32 size = _weights.size();
+
+    _snapshot      = _weights;
+    _snapshotTotal = _total;
+
+    _probability.assign(size, 1.0);
+    _alias.resize(size);
+
+    for (uint32 i = 0; i < size; ++i)
+    {
+        _alias[i] = i;
+    }
+
+    if (_snapshotTotal == 0)
+    {
+        return;
+    }
+
+    //
+    // Vose's alias method: split the columns scaled to an average of one into the small and the large ones,
+    // then fill every small column with the excess of a large one.
+    //
+
+    std::vector<double> scaled(size);
+    std::vector<uint32> small;
+    std::vector<uint32> large;
+
+    small.reserve(size);
+    large.reserve(size);
+
+    for (uint32 i = 0; i < size; ++i)
+    {
+        scaled[i] = (double(_snapshot[i]) * size) / _snapshotTotal;
+
+        if (scaled[i] < 1.0)
+        {
+            small.push_back(i);
+        }
+        else
+        {
+            large.push_back(i);
+        }
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        uint32 less = small.back();
+        uint32 more = large.back();
+
+        small.pop_back();
+        large.pop_back();
+
+        _probability[less] = scaled[less];
+        _alias[less]       = more;
+
+        scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+
+        if (scaled[more] < 1.0)
+        {
+            small.push_back(more);
+        }
+        else
+        {
+            large.push_back(more);
+        }
+    }
+
+    //
+    // Whatever is left is full up to rounding errors
+    //
+
+    for (uint32 i: large)
+    {
+        _probability[i] = 1.0;
+    }
+
+    for (uint32 i: small)
+    {
+        _probability[i] = 1.0;
+    }
+}
+
+void AHBWeightedSampler::SetWeight(uint32 index, uint32 weight)
+{
+    if (index >= _weights.size())
+    {
+        throw std::invalid_argument("Invalid sampler index");
+    }
+
+    _total           = _total - _weights[index] + weight;
+    _weights[index]  = weight;
+
+    //
+    // A weight above the snapshot can not be represented by rejection; when too many
+    // candidates would be rejected, start again from the current situation.
+    //
+
+    if (weight > _snapshot[index] || (_total * 2) < _snapshotTotal)
+    {
+        Rebuild();
+    }
+}
+
+void AHBWeightedSampler::DecWeight(uint32 index)
+{
+    if (GetWeight(index) > 0)
+    {
+        SetWeight(index, _weights[index] - 1);
+    }
+}
+
+uint32 AHBWeightedSampler::GetWeight(uint32 index) const
+{
+    if (index >= _weights.size())
+    {
+        return 0;
+    }
+
+    return _weights[index];
+}
+
+uint32 AHBWeightedSampler::Select()
+{
+    if (Empty())
+    {
+        throw std::runtime_error("All the sampler weights are zero.");
+    }
+
+    //
+    // Since the current total never drops below half of the snapshot total,
+    // on average it takes less than two attempts to accept a candidate.
+    //
+
+    uint32 size = _weights.size();
+
+    for (;;)
+    {
+        uint32 column = urand(0, size - 1);
+        uint32 index  = rand_norm() < _probability[column] ? column : _alias[column];
+
+        if (_weights[index] == 0)
+        {
+            continue;
+        }
+
+        if (_weights[index] == _snapshot[index] || urand(1, _snapshot[index]) <= _weights[index])
+        {
+            return index;
+        }
+    }
+}
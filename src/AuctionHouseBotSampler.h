@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_SAMPLER_H
+#define AUCTION_HOUSE_BOT_SAMPLER_H
+
+#include <vector>
+
+#include "Common.h"
+
+// =============================================================================
+// Weighted random selection of an index, in constant time.
+//
+// The selection is performed on a Vose alias table built on a snapshot of the
+// weights. Weights can be lowered afterwards without rebuilding the table: a
+// candidate is accepted with probability current/snapshot weight, which keeps
+// the selection exactly proportional to the current weights. The table is
+// rebuilt only when a weight grows beyond its snapshot or when the rejection
+// rate would become too high.
+// =============================================================================
+
+class AHBWeightedSampler
+{
+private:
+    std::vector<uint32> _weights;     // Current weights
+    std::vector<uint32> _snapshot;    // Weights the alias table has been built on
+    std::vector<double> _probability; // Alias table: probability to keep the column
+    std::vector<uint32> _alias;       // Alias table: index used otherwise
+
+    uint64 _total;
+    uint64 _snapshotTotal;
+
+    void   Rebuild();
+
+public:
+    AHBWeightedSampler();
+
+    void   Reset(std::vector<uint32> const& weights);
+
+    void   SetWeight(uint32 index, uint32 weight);
+    void   DecWeight(uint32 index);
+    uint32 GetWeight(uint32 index) const;
+
+    uint64 GetTotalWeight() const { return _total; };
+    uint32 Size() const { return _weights.size(); };
+    bool   Empty() const { return _total == 0; };
+
+    uint32 Select();
+};
+
+#endif // AUCTION_HOUSE_BOT_SAMPLER_H
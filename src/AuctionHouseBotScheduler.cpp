@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include "AuctionHouseBotScheduler.h"
+
+AHBScheduler::AHBScheduler()
+{
+    _sequence   = 0;
+    _budget     = 0;
+    _remaining  = 0;
+    _timeBudget = 0;
+}
+
+void AHBScheduler::Schedule(time_t due, Job job, bool budgeted)
+{
+    _jobs.push_back(std::move(job));
+    _budgeted.push_back(budgeted);
+    _timers.emplace(due, _sequence++, _jobs.size() - 1);
+}
+
+void AHBScheduler::Clear()
+{
+    _jobs.clear();
+    _budgeted.clear();
+    _timers = decltype(_timers)();
+}
+
+void AHBScheduler::Update(time_t now)
+{
+    //
+    // Run everything due; the jobs are put back only afterwards, so the ones
+    // running on every update are not picked again in the same one
+    //
+
+    _remaining = _budget;
+    _deadline  = std::chrono::steady_clock::now() + std::chrono::microseconds(_timeBudget);
+
+    while (!_timers.empty() && std::get<0>(_timers.top()) <= now)
+    {
+        Timer  timer = _timers.top();
+        uint32 job   = std::get<2>(timer);
+        _timers.pop();
+
+        //
+        // Out of budget, the budgeted jobs wait for the next update with their due time
+        // and order unchanged, while the others still run
+        //
+
+        if (_budget != 0 && _remaining == 0 && _budgeted[job])
+        {
+            _held.push_back(timer);
+            continue;
+        }
+
+        time_t due = now + _jobs[job]();
+
+        _done.emplace_back(due, _sequence++, job);
+    }
+
+    for (Timer const& timer: _done)
+    {
+        _timers.push(timer);
+    }
+
+    for (Timer const& timer: _held)
+    {
+        _timers.push(timer);
+    }
+
+    _done.clear();
+    _held.clear();
+}
+
+bool AHBScheduler::Spend()
+{
+    if (_budget == 0)
+    {
+        return true;
+    }
+
+    if (_remaining == 0)
+    {
+        return false;
+    }
+
+    _remaining--;
+
+    return true;
+}
+
+bool AHBScheduler::IsOverTime() const
+{
+    return _timeBudget && std::chrono::steady_clock::now() >= _deadline;
+}
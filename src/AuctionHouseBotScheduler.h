@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_SCHEDULER_H
+#define AUCTION_HOUSE_BOT_SCHEDULER_H
+
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+#include "Common.h"
+
+// =============================================================================
+// Timer queue of the periodic jobs of the module.
+//
+// Every job is a task returning the delay, in seconds, before its next run;
+// a delay of zero runs it again on the next update. The due times are kept in
+// a min-heap, so an update with nothing due only looks at the earliest one.
+//
+// Optionally, every update has a budget of work units spent by the jobs. Once
+// it is exhausted the remaining jobs keep their due time, so they come first in
+// the next update: the longest waiting job is always served first. The jobs
+// not spending any unit, like the ones bound to the expiry of the auctions,
+// are scheduled outside of the budget and run when due regardless of it.
+//
+// Every update can also have a time budget, shared by all the jobs it runs:
+// the long running jobs check it to suspend their work until the next update.
+// =============================================================================
+
+class AHBScheduler
+{
+private:
+    typedef std::function<uint32()>           Job;
+    typedef std::tuple<time_t, uint64, uint32> Timer; // (Due time, scheduling order, job index)
+
+    std::vector<Job>                                               _jobs;
+    std::vector<bool>                                              _budgeted; // Whether the job waits for the budget
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> _timers;
+    std::vector<Timer>                                             _done;   // Jobs run by the current update, rescheduled after it
+    std::vector<Timer>                                             _held;   // Jobs due but out of budget, kept with their due time
+
+    uint64 _sequence;  // Breaks the ties between equal due times, first scheduled first served
+    uint32 _budget;    // Work units per update, 0 for no limit
+    uint32 _remaining; // Left in the current update
+
+    uint32                                _timeBudget; // Microseconds per update, 0 for no limit
+    std::chrono::steady_clock::time_point _deadline;   // End of the time budget of the current update
+
+public:
+    AHBScheduler();
+
+    void   Schedule(time_t due, Job job, bool budgeted = true);
+    void   Clear();
+    void   Update(time_t now);
+
+    void   SetBudget(uint32 units) { _budget = units; };
+    bool   Spend();
+
+    void   SetTimeBudget(uint32 microseconds) { _timeBudget = microseconds; };
+    bool   IsOverTime() const;
+
+    uint32 Size() const { return _jobs.size(); };
+};
+
+//
+// Scheduler shared by all the bots
+//
+
+extern AHBScheduler* gScheduler;
+
+#endif // AUCTION_HOUSE_BOT_SCHEDULER_H
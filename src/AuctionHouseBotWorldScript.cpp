@@ -2,13 +2,50 @@
  * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
  */
 
+#include <algorithm>
+#include <iterator>
+
 #include "Config.h"
+#include "GameTime.h"
 #include "Log.h"
+#include "Player.h"
+#include "World.h"
+#include "WorldSession.h"
 
 #include "AuctionHouseBot.h"
 #include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotGovernor.h"
+#include "AuctionHouseBotPlanner.h"
+#include "AuctionHouseBotScheduler.h"
 #include "AuctionHouseBotWorldScript.h"
 
+// =============================================================================
+// Updates the bots on an auction house, resuming the round where the previous
+// update stopped when the scheduler budget runs out. Returns true once every
+// bot has been updated in the round.
+// =============================================================================
+
+static bool UpdateBots(AHBConfig* config, uint32 roles, uint32& served)
+{
+    auto it = gBots.begin();
+    std::advance(it, std::min<size_t>(served, gBots.size()));
+
+    for (; it != gBots.end(); ++it)
+    {
+        if (!gScheduler->Spend())
+        {
+            return false;
+        }
+
+        (*it)->Update(config, roles, gBots.size() - served);
+        served++;
+    }
+
+    served = 0;
+
+    return true;
+}
+
 // =============================================================================
 // Initialization of the bot during the world startup
 // =============================================================================
@@ -104,7 +141,9 @@ void AHBot_WorldScript::OnBeforeConfigLoad(bool reload)
         // Clear the bots array; this way they wont be used anymore during the initialization stage.
         //
 
+        gScheduler->Clear();
         DeleteBots();
+        gPlanner->Stop();
 
         //
         // Reload the configuration for the auction houses
@@ -119,6 +158,9 @@ void AHBot_WorldScript::OnBeforeConfigLoad(bool reload)
         //
 
         PopulateBots();
+        StartPlanner();
+        ConfigureGovernor();
+        ScheduleJobs();
     }
 }
 
@@ -139,6 +181,233 @@ void AHBot_WorldScript::OnStartup()
     //
 
     PopulateBots();
+    StartPlanner();
+    ConfigureGovernor();
+    ScheduleJobs();
+}
+
+void AHBot_WorldScript::OnUpdate(uint32 diff)
+{
+    gGovernor->Update(diff);
+}
+
+void AHBot_WorldScript::OnShutdown()
+{
+    //
+    // No more jobs for the bots: they are going away
+    //
+
+    gScheduler->Clear();
+
+    //
+    // The planner thread must be gone before the configurations it reads from
+    //
+
+    gPlanner->Stop();
+
+    //
+    // Release the bots players and sessions while the world is still there
+    //
+
+    DeleteBots();
+}
+
+void AHBot_WorldScript::StartPlanner()
+{
+    if (!sConfigMgr->GetOption<bool>("AuctionHouseBot.SellerPlanner", false))
+    {
+        return;
+    }
+
+    uint32 queueSize = sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerPlannerQueueSize", 256);
+
+    gPlanner->Start({ gAllianceConfig, gHordeConfig, gNeutralConfig }, queueSize);
+}
+
+void AHBot_WorldScript::ConfigureGovernor()
+{
+    gGovernor->Configure(
+        sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Governor"            , false),
+        sConfigMgr->GetOption<uint32>("AuctionHouseBot.GovernorTargetDiff"  , 100),
+        sConfigMgr->GetOption<uint32>("AuctionHouseBot.GovernorMinShare"    , 10),
+        sConfigMgr->GetOption<uint32>("AuctionHouseBot.GovernorIncrease"    , 5),
+        sConfigMgr->GetOption<float> ("AuctionHouseBot.GovernorDecrease"    , 0.5f));
+}
+
+void AHBot_WorldScript::ScheduleJobs()
+{
+    gScheduler->Clear();
+    gScheduler->SetBudget(sConfigMgr->GetOption<uint32>("AuctionHouseBot.BotsPerTick", 0));
+    gScheduler->SetTimeBudget(sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerTimeBudget", 0));
+
+    time_t now = GameTime::GetGameTime().count();
+
+    //
+    // The auction houses served by the bots
+    //
+
+    std::vector<AHBConfig*> configs;
+
+    if (!sWorld->getBoolConfig(CONFIG_ALLOW_TWO_SIDE_INTERACTION_AUCTION))
+    {
+        configs.push_back(gAllianceConfig);
+        configs.push_back(gHordeConfig);
+    }
+
+    configs.push_back(gNeutralConfig);
+
+    //
+    // Maintenance of the markets
+    //
+
+    uint32 maintenanceInterval = sConfigMgr->GetOption<uint32>("AuctionHouseBot.MaintenanceInterval", 60);
+
+    gScheduler->Schedule(now, [this, maintenanceInterval]()
+    {
+        UpdateMarkets(GameTime::GetGameTime().count());
+        return maintenanceInterval;
+    }, false);
+
+    //
+    // The expiring bot auctions are shared by all the bots: any of them can relist them, once. The job
+    // runs again when the next bot auction enters the relisting window, a minute ahead of its expiry,
+    // and at least once per minute for the auctions listed in the meantime. It is not held back by the
+    // bots per update budget, since the core expires the auction as soon as it enters the window.
+    //
+
+    gScheduler->Schedule(now, [configs]()
+    {
+        if (!gAllianceConfig->RelistExpired && !gHordeConfig->RelistExpired && !gNeutralConfig->RelistExpired)
+        {
+            return uint32(MINUTE);
+        }
+
+        if (!gBots.empty())
+        {
+            (*gBots.begin())->Relist();
+        }
+
+        time_t now  = GameTime::GetGameTime().count();
+        time_t next = now + 2 * MINUTE;
+
+        for (AHBConfig* config: configs)
+        {
+            time_t expiry = config->GetNextBotExpiry();
+
+            if (config->RelistExpired && expiry != 0)
+            {
+                next = std::min(next, expiry);
+            }
+        }
+
+        return uint32(std::clamp<time_t>(next - MINUTE - now, 1, MINUTE));
+    }, false);
+
+    //
+    // Selling and buying, with their own period for every auction house. A disabled role only checks
+    // again once per minute, in case it gets enabled by a command. With a limited amount of bots per
+    // update, a round over the bots spans several updates and the period starts once it is complete.
+    //
+
+    for (AHBConfig* config: configs)
+    {
+        gScheduler->Schedule(now, [config, served = uint32(0)]() mutable
+        {
+            if (!config->AHBSeller)
+            {
+                served = 0;
+                return uint32(MINUTE);
+            }
+
+            if (!UpdateBots(config, AHB_ROLE_SELLER, served))
+            {
+                return uint32(0);
+            }
+
+            return config->SellerInterval;
+        });
+
+        gScheduler->Schedule(now + config->GetBiddingInterval() * MINUTE, [config, served = uint32(0)]() mutable
+        {
+            if (!config->AHBBuyer)
+            {
+                served = 0;
+                return uint32(MINUTE);
+            }
+
+            if (!UpdateBots(config, AHB_ROLE_BUYER, served))
+            {
+                return uint32(0);
+            }
+
+            return config->GetBiddingInterval() * MINUTE;
+        });
+    }
+}
+
+void AHBot_WorldScript::UpdateMarkets(time_t now)
+{
+    //
+    // Follow the online population with the auction houses targets
+    //
+
+    uint32 players = sWorld->GetPlayerCount();
+
+    gAllianceConfig->UpdatePopulation(players);
+    gHordeConfig->UpdatePopulation   (players);
+    gNeutralConfig->UpdatePopulation (players);
+
+    //
+    // Collect the levels of the players, per auction house they can use
+    //
+
+    if (gAllianceConfig->LevelTargeting || gHordeConfig->LevelTargeting || gNeutralConfig->LevelTargeting)
+    {
+        std::vector<uint8> allianceLevels;
+        std::vector<uint8> hordeLevels;
+        std::vector<uint8> neutralLevels;
+
+        for (auto const& session: sWorld->GetAllSessions())
+        {
+            Player* player = session.second->GetPlayer();
+
+            if (!player || !player->IsInWorld())
+            {
+                continue;
+            }
+
+            uint8 level = player->GetLevel();
+
+            if (player->GetTeamId() == TEAM_ALLIANCE)
+            {
+                allianceLevels.push_back(level);
+            }
+            else
+            {
+                hordeLevels.push_back(level);
+            }
+
+            neutralLevels.push_back(level);
+        }
+
+        if (sWorld->getBoolConfig(CONFIG_ALLOW_TWO_SIDE_INTERACTION_AUCTION))
+        {
+            allianceLevels = neutralLevels;
+            hordeLevels    = neutralLevels;
+        }
+
+        gAllianceConfig->SetPlayerLevels(allianceLevels);
+        gHordeConfig->SetPlayerLevels   (hordeLevels);
+        gNeutralConfig->SetPlayerLevels (neutralLevels);
+    }
+
+    //
+    // Keep the markets small enough for the players to browse them quickly
+    //
+
+    gAllianceConfig->UpdateBrowseCost(now);
+    gHordeConfig->UpdateBrowseCost   (now);
+    gNeutralConfig->UpdateBrowseCost (now);
 }
 
 void AHBot_WorldScript::DeleteBots()
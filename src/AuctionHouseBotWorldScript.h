@@ -16,12 +16,18 @@ class AHBot_WorldScript : public WorldScript
 private:
     void DeleteBots();
     void PopulateBots();
+    void StartPlanner();
+    void ScheduleJobs();
+    void ConfigureGovernor();
+    void UpdateMarkets(time_t now);
 
 public:
     AHBot_WorldScript();
 
     void OnBeforeConfigLoad(bool reload) override;
     void OnStartup() override;
+    void OnShutdown() override;
+    void OnUpdate(uint32 diff) override;
 };
 
 #endif /* AUCTION_HOUSE_BOT_WORLD_SCRIPT_H */
@@ -25,6 +25,7 @@ EndScriptData */
 #include "ScriptMgr.h"
 #include "Chat.h"
 #include "AuctionHouseBot.h"
+#include "AuctionHouseBotGovernor.h"
 #include "Config.h"
 
 #if AC_COMPILER == AC_COMPILER_GNU
@@ -166,6 +167,14 @@ public:
 
             return true;
         }
+        else if (strncmp(opt, "governor", l) == 0)
+        {
+            handler->SendSysMessage(std::string("AHBot governor: ") + (gGovernor->IsEnabled() ? "enabled" : "disabled"));
+            handler->SendSysMessage("World diff: last " + std::to_string(gGovernor->GetLastDiff()) + " ms, smoothed " + std::to_string(gGovernor->GetSmoothedDiff()) + " ms, target " + std::to_string(gGovernor->GetTargetDiff()) + " ms");
+            handler->SendSysMessage("Work share: " + std::to_string(gGovernor->GetShare()) + "% (" + std::to_string(gGovernor->GetDecreases()) + " decreases, " + std::to_string(gGovernor->GetIncreases()) + " increases)");
+
+            return true;
+        }
 
         //
         // Retrieve the auction house type
@@ -209,6 +218,7 @@ public:
             handler->PSendSysMessage("buyer - enable/disable buyer");
             handler->PSendSysMessage("seller - enable/disabler seller");
             handler->PSendSysMessage("usemarketprice - enable/disabler selling at market price");
+            handler->PSendSysMessage("governor - show the load governor state");
             handler->PSendSysMessage("ahexpire - remove all bot auctions");
             handler->PSendSysMessage("minitems - set min auctions");
             handler->PSendSysMessage("maxitems - set max auctions");